@@ -4,6 +4,7 @@
 
 #include "gsge.h"
 #include "renderer/settings.h"
+#include "core/benchmark.h"
 
 // #include <easy/profiler.h>
 #include <tracy/Tracy.hpp>
@@ -21,6 +22,19 @@ int main(int argc, char *argv[])
 
     GSGE_SETTINGS_INSTANCE_DECL;
     settings.parseCmdParams(std::vector<std::string_view>{argv + 1, argv + argc});
+
+    if (settings.Benchmark.transformScaling)
+    {
+        benchmark::transformScaling();
+        return EXIT_SUCCESS;
+    }
+
+    if (settings.Benchmark.assetLoading)
+    {
+        benchmark::assetLoading();
+        return EXIT_SUCCESS;
+    }
+
     gsge app;
 
     try
@@ -38,6 +38,20 @@ void camera::setCenter(glm::vec3 newCenter)
     updateViewMatrix();
 }
 
+void camera::lookAt(glm::vec3 target)
+{
+    glm::vec3 direction = target - position;
+    if (glm::length(direction) == 0.0f)
+        return;
+
+    // Inverse of the direction computed from pitch and yaw in update(), so mouse look continues from here
+    front = glm::normalize(direction);
+    pitch = glm::degrees(-asin(front.y));
+    yaw = glm::degrees(atan2(-front.x, front.z));
+
+    updateViewMatrix();
+}
+
 void camera::setUpVector(glm::vec3 newUpVector)
 {
     up = newUpVector;
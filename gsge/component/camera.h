@@ -21,6 +21,7 @@ class camera
 
     void setPosition(glm::vec3 newPosition);
     void setCenter(glm::vec3 newCenter);                 //!< Set point in space for the camera to look at
+    void lookAt(glm::vec3 target);                       //!< Turn camera towards the point, keeps its position
     void setUpVector(glm::vec3 newUpVector);             //!< Set up vector for the camera
     void setFov(float newFov);                           //!< Set field of view for the camera
     void setAspect(float newAspect);                     //!< Set aspect ratio for the camera
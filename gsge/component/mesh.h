@@ -1,22 +1,16 @@
 #pragma once
 
-#include <vector>
-
-#include <glm/glm.hpp>
+#include "../types.h"
 
 namespace component
 {
+// Reference to mesh geometry, stored once in MeshRegistry no matter how many entities use it.
+// Copying the component copies no geometry
 struct mesh
 {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::u16> indices;
-    std::vector<glm::vec3> normals;
-
-    uint32_t nVertices = 0;
-    uint32_t nIndices = 0;
-    uint32_t nFaces = 0;
-
-    uint32_t firstIndex = 0;   // for indexed drawing
-    uint32_t vertexOffset = 0; // for indexed drawing
+    MeshHandle handle = invalidMeshHandle;
+    uint32_t firstIndex = 0;  // First index of the mesh in the index lump of its index type (MeshInfo::indexType)
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0; // First vertex of the mesh in the vertex lump
 };
 } // namespace component
@@ -0,0 +1,262 @@
+#include "assetManager.h"
+
+component::mesh AssetManager::loadMesh(const std::string &fileName, uint32_t meshId)
+{
+    ZoneScoped;
+
+    const std::string meshName = getMeshName(fileName, meshId);
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (MeshHandle handle = meshRegistry.find(meshName); handle != invalidMeshHandle)
+            return makeComponent(handle, meshRegistry.get(handle));
+    }
+
+    return readMesh(meshName, fileName, meshId);
+}
+
+std::shared_future<component::mesh> AssetManager::loadMeshAsync(JobSystem &jobSystem, const std::string &fileName,
+                                                                 uint32_t meshId)
+{
+    const std::string meshName = getMeshName(fileName, meshId);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto pending = asyncMeshes.find(meshName); pending != asyncMeshes.end())
+        return pending->second;
+
+    std::shared_future<component::mesh> future;
+    if (MeshHandle handle = meshRegistry.find(meshName); handle != invalidMeshHandle)
+    {
+        std::promise<component::mesh> loaded;
+        loaded.set_value(makeComponent(handle, meshRegistry.get(handle)));
+        future = loaded.get_future().share();
+    }
+    else
+    {
+        future = jobSystem.submit([this, fileName, meshId, meshName]() { return readMesh(meshName, fileName, meshId); }).share();
+    }
+
+    asyncMeshes.emplace(meshName, future);
+    return future;
+}
+
+component::mesh AssetManager::addGeneratedMesh(const std::string &meshName, std::span<const glm::vec3> vertices,
+                                               std::span<const glm::vec3> normals, std::span<const glm::u32> indices)
+{
+    return addMesh(meshName, vertices, normals, indices, MeshRegistry::computeBoundingSphere(vertices));
+}
+
+/**
+ * \brief Add the mesh from its cooked file, or import it with Assimp and cook it when the cooked file is missing or stale.
+ */
+component::mesh AssetManager::readMesh(const std::string &meshName, const std::string &fileName, uint32_t meshId)
+{
+    ZoneScoped;
+
+    if (GltfMesh::isGltfFile(fileName))
+        return readGltfMesh(meshName, fileName, meshId);
+
+    if (!meshCacheEnabled)
+    {
+        ImportedMesh imported = importMesh(fileName, meshId);
+        return addMesh<glm::u32>(meshName, imported.vertices, imported.normals, imported.indices,
+                                 MeshRegistry::computeBoundingSphere(imported.vertices));
+    }
+
+    const uint64_t sourceHash = meshCache::hashFile(fileName);
+    const std::string cachePath = meshCache::getCachePath(fileName, meshId);
+
+    if (meshCache::CookedMesh cooked; meshCache::load(cachePath, sourceHash, importFlags, meshId, cooked))
+    {
+        SPDLOG_INFO("[Assets] Loaded {} from mesh cache, vertices: {}", meshName, cooked.vertices.size());
+        if (!cooked.indices16.empty())
+            return addMesh(meshName, cooked.vertices, cooked.normals, cooked.indices16, cooked.boundingSphere);
+        return addMesh(meshName, cooked.vertices, cooked.normals, cooked.indices32, cooked.boundingSphere);
+    }
+
+    ImportedMesh imported = importMesh(fileName, meshId);
+    glm::vec4 boundingSphere = MeshRegistry::computeBoundingSphere(imported.vertices);
+
+    if (sourceHash != 0)
+    {
+        // Cooked with the index type the registry selects, so warm starts copy indices without conversion
+        IndexType indexType = MeshRegistry::selectIndexType(imported.vertices.size());
+        std::vector<glm::u16> indices16;
+        std::span<const std::byte> indexData = std::as_bytes(std::span(imported.indices));
+
+        if (indexType == IndexType::Uint16)
+        {
+            indices16.assign(imported.indices.begin(), imported.indices.end());
+            indexData = std::as_bytes(std::span(indices16));
+        }
+
+        meshCache::write(cachePath, sourceHash, importFlags, meshId, boundingSphere, imported.vertices, imported.normals,
+                         indexType, indexData);
+    }
+
+    return addMesh<glm::u32>(meshName, imported.vertices, imported.normals, imported.indices, boundingSphere);
+}
+
+AssetManager::ImportedMesh AssetManager::importMesh(const std::string &fileName, uint32_t meshId)
+{
+    ZoneScoped;
+
+    Assimp::Importer importer;
+    ImportedMesh imported;
+
+    const aiScene *aiScene = importer.ReadFile(fileName, importFlags);
+
+    if (aiScene != nullptr)
+    {
+        SPDLOG_INFO("[Assets] Loaded " + fileName + " model. Meshes: " + std::to_string(aiScene->mNumMeshes) +
+                    ", vertices: " + std::to_string(aiScene->mMeshes[meshId]->mNumVertices));
+    }
+    else
+    {
+        SPDLOG_ERROR("[Assets] Failed to load model {}. Error: {}", fileName, importer.GetErrorString());
+        throw std::runtime_error("IO error");
+    }
+
+    const aiMesh *mesh = aiScene->mMeshes[meshId];
+
+    imported.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+    for (size_t i = 0; i < mesh->mNumFaces; i++)
+    {
+        imported.indices.push_back(mesh->mFaces[i].mIndices[0]);
+        imported.indices.push_back(mesh->mFaces[i].mIndices[1]);
+        imported.indices.push_back(mesh->mFaces[i].mIndices[2]);
+    }
+
+    imported.normals.reserve(mesh->mNumVertices);
+    for (size_t i = 0; i < mesh->mNumVertices; ++i)
+    {
+        aiVector3D n = mesh->mNormals[i];
+        imported.normals.push_back(glm::vec3(n.x, n.y, n.z));
+    }
+
+    glm::vec3 *pVertices = reinterpret_cast<glm::vec3 *>(mesh->mVertices);
+    imported.vertices.assign(pVertices, pVertices + mesh->mNumVertices);
+
+    return imported;
+}
+
+/**
+ * \brief Parse the glTF file outside of the lock, then convert its accessors straight into lumps reserved in the registry.
+ */
+component::mesh AssetManager::readGltfMesh(const std::string &meshName, const std::string &fileName, uint32_t meshId)
+{
+    ZoneScoped;
+
+    GltfMesh gltfMesh;
+    gltfMesh.parse(fileName, meshId);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (MeshHandle handle = meshRegistry.find(meshName); handle != invalidMeshHandle)
+        return makeComponent(handle, meshRegistry.get(handle));
+
+    MeshAllocation allocation = meshRegistry.allocate(meshName, gltfMesh.getVertexCount(), gltfMesh.getIndexCount());
+    if (allocation.indexType == IndexType::Uint16)
+        gltfMesh.copy(allocation.vertices, allocation.normals, allocation.indices16);
+    else
+        gltfMesh.copy(allocation.vertices, allocation.normals, allocation.indices32);
+    meshRegistry.setBoundingSphere(allocation.handle, MeshRegistry::computeBoundingSphere(allocation.vertices));
+    referenceCounts.resize(meshRegistry.size(), 0);
+
+    return makeComponent(allocation.handle, meshRegistry.get(allocation.handle));
+}
+
+template <typename Index>
+component::mesh AssetManager::addMesh(const std::string &meshName, std::span<const glm::vec3> vertices,
+                                      std::span<const glm::vec3> normals, std::span<const Index> indices,
+                                      const glm::vec4 &boundingSphere)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (MeshHandle handle = meshRegistry.find(meshName); handle != invalidMeshHandle)
+        return makeComponent(handle, meshRegistry.get(handle));
+
+    MeshHandle handle = meshRegistry.add(meshName, vertices, normals, indices, boundingSphere);
+    referenceCounts.resize(meshRegistry.size(), 0);
+
+    return makeComponent(handle, meshRegistry.get(handle));
+}
+
+/**
+ * \brief Reference counts are changed on the main thread while import jobs may still grow them, so they take the lock.
+ */
+void AssetManager::addReference(MeshHandle handle)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (handle != invalidMeshHandle)
+        referenceCounts[handle]++;
+}
+
+void AssetManager::releaseReference(MeshHandle handle)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (handle != invalidMeshHandle && referenceCounts[handle] > 0)
+        referenceCounts[handle]--;
+}
+
+uint32_t AssetManager::getReferenceCount(MeshHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return referenceCounts[handle];
+}
+
+MeshRegistry &AssetManager::getMeshRegistry()
+{
+    return meshRegistry;
+}
+
+void AssetManager::setMeshCacheEnabled(bool enabled)
+{
+    meshCacheEnabled = enabled;
+}
+
+void AssetManager::logMemoryReport() const
+{
+    constexpr double kiB = 1024.0;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    size_t vertexBytes = meshRegistry.getVertexLump().size() * sizeof(glm::vec3);
+    size_t normalBytes = meshRegistry.getNormalLump().size() * sizeof(glm::vec3);
+    size_t indexBytes =
+        meshRegistry.getIndexLump16().size() * sizeof(glm::u16) + meshRegistry.getIndexLump32().size() * sizeof(glm::u32);
+    size_t arenaBytes = vertexBytes + normalBytes + indexBytes;
+
+    size_t references = 0;
+    size_t copiedBytes = 0;
+    for (MeshHandle handle = 0; handle < referenceCounts.size(); handle++)
+    {
+        const MeshInfo &info = meshRegistry.get(handle);
+        size_t indexSize = info.indexType == IndexType::Uint16 ? sizeof(glm::u16) : sizeof(glm::u32);
+        size_t meshBytes = info.vertexCount * 2 * sizeof(glm::vec3) + info.indexCount * indexSize;
+
+        references += referenceCounts[handle];
+        copiedBytes += referenceCounts[handle] * (2 * meshBytes + 3 * sizeof(std::vector<glm::vec3>));
+    }
+
+    size_t componentBytes = references * sizeof(component::mesh);
+
+    SPDLOG_INFO("[Assets] Memory report: {} unique meshes, {} references", meshRegistry.size(), references);
+    SPDLOG_INFO("[Assets]   geometry arena: {:.1f} KiB (vertices {:.1f}, normals {:.1f}, indices {:.1f})", arenaBytes / kiB,
+                vertexBytes / kiB, normalBytes / kiB, indexBytes / kiB);
+    SPDLOG_INFO("[Assets]   mesh components: {:.1f} KiB", componentBytes / kiB);
+    SPDLOG_INFO("[Assets]   per-entity geometry copies would take: {:.1f} KiB, {:.1f}x more", copiedBytes / kiB,
+                arenaBytes + componentBytes > 0 ? static_cast<double>(copiedBytes) / (arenaBytes + componentBytes) : 0.0);
+}
+
+std::string AssetManager::getMeshName(const std::string &fileName, uint32_t meshId)
+{
+    return fileName + "#" + std::to_string(meshId);
+}
+
+component::mesh AssetManager::makeComponent(MeshHandle handle, const MeshInfo &info)
+{
+    return {
+        .handle = handle,
+        .firstIndex = info.firstIndex,
+        .indexCount = info.indexCount,
+        .vertexOffset = info.vertexOffset,
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable : 26451)
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h> // Post processing flags
+#include <assimp/scene.h>       // Output data structure
+#pragma warning(pop)
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <tracy/Tracy.hpp>
+
+#include "../component/mesh.h"
+#include "gltfMesh.h"
+#include "jobSystem.h"
+#include "meshCache.h"
+#include "meshRegistry.h"
+
+/**
+ * \brief Loads model files once and hands out lightweight mesh components referencing the shared geometry.
+ *
+ * Geometry lives in the MeshRegistry arena, entities hold component::mesh (handle and ranges, 16 bytes), so copying
+ * a mesh component to any number of entities copies no geometry. The scene keeps reference counts up to date through
+ * addReference() and releaseReference() when mesh components are created and destroyed.
+ *
+ * loadMeshAsync() reads and imports files on the job system, every job uses its own Assimp::Importer. Only adding
+ * the imported geometry to the registry is serialized.
+ *
+ * Imported meshes are cooked into the mesh cache. Later runs map the cooked file and copy it straight into the
+ * registry arena, Assimp is only used when the source model file changed.
+ *
+ * glTF files (.gltf, .glb) are loaded with fastgltf instead of Assimp and bypass the mesh cache, their accessors are
+ * converted straight from the mapped buffers into the registry arena.
+ */
+class AssetManager
+{
+  public:
+    /**
+     * \brief Return mesh meshId of the model file, import the file only when the mesh is not loaded yet.
+     */
+    component::mesh loadMesh(const std::string &fileName, uint32_t meshId = 0);
+
+    /**
+     * \brief Import mesh meshId of the model file on the job system.
+     *
+     * Requests of a mesh already loaded or being loaded share one future. Import errors are rethrown by get().
+     */
+    std::shared_future<component::mesh> loadMeshAsync(JobSystem &jobSystem, const std::string &fileName, uint32_t meshId = 0);
+
+    /**
+     * \brief Add mesh generated at runtime, e.g. procedural geometry of benchmark scenes. Not written to the mesh cache.
+     *
+     * Returns the existing mesh if the name is taken.
+     */
+    component::mesh addGeneratedMesh(const std::string &meshName, std::span<const glm::vec3> vertices,
+                                     std::span<const glm::vec3> normals, std::span<const glm::u32> indices);
+
+    void addReference(MeshHandle handle);
+    void releaseReference(MeshHandle handle);
+    uint32_t getReferenceCount(MeshHandle handle) const;
+
+    MeshRegistry &getMeshRegistry();
+
+    void setMeshCacheEnabled(bool enabled); //!< Disabled cache neither reads nor writes cooked meshes
+
+    /**
+     * \brief Log resident geometry memory against the memory per-entity geometry copies would take.
+     *
+     * Before mesh sharing every entity owned copies of vertices, normals and indices of its mesh and the scene copied
+     * them again into its host lumps, so the comparison counts two copies per reference.
+     */
+    void logMemoryReport() const;
+
+  private:
+    // Needs to have aiProcess_FlipWindingOrder ENABLED!!!
+    // assimp defaults to CW winding order (and normal calculation) while Vulkan has Y axis inverted causing
+    // normals to be inverted. Proper setting for vulkan renderer in such situation are:
+    // rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    // rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    static constexpr uint32_t importFlags = aiProcess_Triangulate | aiProcess_FlipWindingOrder | aiProcess_JoinIdenticalVertices;
+
+    struct ImportedMesh
+    {
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::u32> indices;
+    };
+
+    MeshRegistry meshRegistry;
+    std::vector<uint32_t> referenceCounts; //!< Mesh components referencing each mesh
+
+    mutable std::mutex registryMutex; //!< Guards meshRegistry, referenceCounts and asyncMeshes
+    std::unordered_map<std::string, std::shared_future<component::mesh>> asyncMeshes;
+    bool meshCacheEnabled{true};
+
+    component::mesh readMesh(const std::string &meshName, const std::string &fileName, uint32_t meshId);
+    static ImportedMesh importMesh(const std::string &fileName, uint32_t meshId);
+    component::mesh readGltfMesh(const std::string &meshName, const std::string &fileName, uint32_t meshId);
+    template <typename Index>
+    component::mesh addMesh(const std::string &meshName, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                            std::span<const Index> indices, const glm::vec4 &boundingSphere);
+    static std::string getMeshName(const std::string &fileName, uint32_t meshId);
+    static component::mesh makeComponent(MeshHandle handle, const MeshInfo &info);
+};
@@ -0,0 +1,177 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <numeric>
+
+namespace benchmark
+{
+static void populateRegistry(entt::registry &registry, size_t entityCount)
+{
+    using namespace DirectX;
+
+    for (size_t i = 0; i < entityCount; ++i)
+    {
+        entt::entity entity = registry.create();
+        registry.emplace<component::transform>(entity, XMFLOAT4A(i * 2.f, 0.f, 0.f, 0.f));
+        registry.emplace<component::motion>(entity, XMFLOAT4A(0.1f, 0.f, 0.f, 0.f),
+                                            XMFLOAT4A(XMConvertToRadians(-30.f), XMConvertToRadians(-15.f), 0.f, 0.f));
+    }
+}
+
+void transformScaling()
+{
+    constexpr std::array<size_t, 4> entityCounts = {8'000, 64'000, 256'000, 1'000'000};
+    constexpr std::array<uint32_t, 5> threadCounts = {1, 2, 4, 8, 16};
+    constexpr std::array<transformKernels::Isa, 3> kernels = {transformKernels::Isa::Scalar, transformKernels::Isa::Avx2,
+                                                              transformKernels::Isa::Avx512};
+    constexpr int warmupIterations = 3;
+    constexpr int iterations = 20;
+
+    SPDLOG_INFO("[Benchmark] Transform integration scaling, {} hardware threads", std::thread::hardware_concurrency());
+    SPDLOG_INFO("[Benchmark] {:>10} {:>8} {:>8} {:>12} {:>8}", "entities", "kernel", "threads", "ms/update", "speedup");
+
+    for (size_t entityCount : entityCounts)
+    {
+        entt::registry registry;
+        populateRegistry(registry, entityCount);
+
+        std::vector<entt::entity> entities(registry.storage<component::transform>().begin(),
+                                           registry.storage<component::transform>().end());
+        std::vector<DirectX::XMMATRIX> matrices(entityCount);
+
+        float baselineTime = 0.0f;
+
+        for (transformKernels::Isa kernel : kernels)
+        {
+            if (!transformKernels::isSupported(kernel))
+                continue;
+
+            for (uint32_t threadCount : threadCounts)
+            {
+                JobSystem jobSystem(threadCount);
+                TransformPool pool;
+                pool.setKernel(kernel);
+                pool.build(registry, entities);
+
+                for (int i = 0; i < warmupIterations; ++i)
+                    pool.integrate(jobSystem, 0.001f, matrices.data());
+
+                timer updateTimer;
+                for (int i = 0; i < iterations; ++i)
+                    pool.integrate(jobSystem, 0.001f, matrices.data());
+                float updateTime = updateTimer.getTimeAsSeconds() * 1000.0f / iterations;
+
+                if (baselineTime == 0.0f)
+                    baselineTime = updateTime;
+
+                SPDLOG_INFO("[Benchmark] {:>10} {:>8} {:>8} {:>12.3f} {:>7.2f}x", entityCount, transformKernels::getName(kernel),
+                            threadCount, updateTime, baselineTime / updateTime);
+            }
+        }
+    }
+}
+
+void assetLoading()
+{
+    constexpr std::array<const char *, 7> models = {"models/suzanne.fbx",         "models/suzanne_smooth.fbx",
+                                                    "models/icoSphere.fbx",       "models/testCube.fbx",
+                                                    "models/CompanionCube.fbx",   "models/squareFloor.fbx",
+                                                    "models/simpleCube.fbx"};
+    constexpr int iterations = 10;
+
+    auto loadModels = [&](bool meshCacheEnabled) {
+        timer loadTimer;
+        for (int i = 0; i < iterations; ++i)
+        {
+            AssetManager assetManager;
+            assetManager.setMeshCacheEnabled(meshCacheEnabled);
+
+            for (const char *model : models)
+                assetManager.loadMesh(model);
+        }
+        return loadTimer.getTimeAsSeconds() * 1000.0f / iterations;
+    };
+
+    SPDLOG_INFO("[Benchmark] Asset loading, {} models", models.size());
+
+    // Cooks missing or stale meshes, so the cooked run below never falls back to Assimp
+    {
+        AssetManager assetManager;
+        for (const char *model : models)
+            assetManager.loadMesh(model);
+    }
+
+    float importTime = loadModels(false);
+    float cookedTime = loadModels(true);
+
+    SPDLOG_INFO("[Benchmark] {:>10} {:>12}", "source", "ms/scene");
+    SPDLOG_INFO("[Benchmark] {:>10} {:>12.3f}", "assimp", importTime);
+    SPDLOG_INFO("[Benchmark] {:>10} {:>12.3f}", "cooked", cookedTime);
+    SPDLOG_INFO("[Benchmark] Cooked meshes load {:.1f}x faster", cookedTime > 0.0f ? importTime / cookedTime : 0.0f);
+}
+
+static std::string formatParameterValue(const ReportParameter::second_type &value, bool quoteStrings)
+{
+    if (const bool *flag = std::get_if<bool>(&value))
+        return *flag ? "true" : "false";
+    if (const double *number = std::get_if<double>(&value))
+        return std::format("{}", *number);
+    return quoteStrings ? std::format("\"{}\"", std::get<std::string>(value)) : std::get<std::string>(value);
+}
+
+void writeFrameTimeReport(const std::string &fileName, const std::vector<ReportParameter> &parameters,
+                          const std::vector<FramePhaseTimes> &frames)
+{
+    std::ofstream report(fileName, std::ios::trunc);
+    if (!report.is_open())
+        throw std::runtime_error(std::format("[Benchmark] Failed to open report file {}", fileName));
+
+    const bool csv = fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".csv") == 0;
+
+    if (csv)
+    {
+        for (const auto &[name, value] : parameters)
+            report << name << ',';
+        report << "phase,mean_ms,p50_ms,p95_ms,p99_ms,p99.9_ms,max_ms,samples\n";
+
+        for (const auto &[phaseName, phase] : framePhases)
+        {
+            PhaseStatistics statistics = computePhaseStatistics(frames, phase);
+            for (const auto &[name, value] : parameters)
+                report << formatParameterValue(value, false) << ',';
+            report << std::format("{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{}\n", phaseName, statistics.mean,
+                                  statistics.p50, statistics.p95, statistics.p99, statistics.p999, statistics.max,
+                                  statistics.samples);
+        }
+    }
+    else
+    {
+        report << "{\n  \"parameters\": {";
+        for (size_t i = 0; i < parameters.size(); ++i)
+            report << std::format("{}\n    \"{}\": {}", i ? "," : "", parameters[i].first,
+                                  formatParameterValue(parameters[i].second, true));
+        report << "\n  },\n  \"phases\": {";
+
+        for (size_t i = 0; i < framePhases.size(); ++i)
+        {
+            PhaseStatistics statistics = computePhaseStatistics(frames, framePhases[i].second);
+            report << std::format("{}\n    \"{}\": {{\"mean_ms\": {:.4f}, \"p50_ms\": {:.4f}, \"p95_ms\": {:.4f}, "
+                                  "\"p99_ms\": {:.4f}, \"p99.9_ms\": {:.4f}, \"max_ms\": {:.4f}, \"samples\": {}}}",
+                                  i ? "," : "", framePhases[i].first, statistics.mean, statistics.p50, statistics.p95,
+                                  statistics.p99, statistics.p999, statistics.max, statistics.samples);
+        }
+        report << "\n  }\n}\n";
+    }
+
+    SPDLOG_INFO("[Benchmark] Frame time report of {} frames written to {}", frames.size(), fileName);
+    for (const auto &[phaseName, phase] : framePhases)
+    {
+        PhaseStatistics statistics = computePhaseStatistics(frames, phase);
+        SPDLOG_INFO("[Benchmark] {:>10}: mean {:8.3f} ms, p50 {:8.3f} ms, p99 {:8.3f} ms, max {:8.3f} ms", phaseName,
+                    statistics.mean, statistics.p50, statistics.p99, statistics.max);
+    }
+}
+} // namespace benchmark
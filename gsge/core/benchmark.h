@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include <entt/entity/registry.hpp>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include "assetManager.h"
+#include "frameRecorder.h"
+#include "jobSystem.h"
+#include "../timer.h"
+#include "transformPool.h"
+
+/**
+ * \brief Built-in CPU benchmarks, selected with command line parameters.
+ */
+namespace benchmark
+{
+/**
+ * \brief Measure scaling of transform integration with the kernel and the number of job system threads.
+ *
+ * Runs TransformPool::integrate with every kernel supported by the CPU for 1/2/4/8/16 threads on scenes of 8k to
+ * 1M moving entities and logs time per update and speedup over the single-threaded scalar kernel.
+ */
+void transformScaling();
+
+/**
+ * \brief Compare loading the scene models through Assimp with loading their cooked copies from the mesh cache.
+ *
+ * Every iteration loads all models into a fresh AssetManager, so nothing is shared between iterations except
+ * the OS file cache.
+ */
+void assetLoading();
+
+// Parameter of a benchmark run written to its report
+using ReportParameter = std::pair<std::string, std::variant<bool, double, std::string>>;
+
+/**
+ * \brief Write mean, p50, p95, p99, p99.9 and max of every frame phase to a JSON file, or to a CSV file if the name
+ * ends with .csv.
+ *
+ * Every CSV row repeats the parameters of the run, so reports of several runs can be concatenated into one table.
+ */
+void writeFrameTimeReport(const std::string &fileName, const std::vector<ReportParameter> &parameters,
+                          const std::vector<FramePhaseTimes> &frames);
+} // namespace benchmark
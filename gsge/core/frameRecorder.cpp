@@ -0,0 +1,207 @@
+#include "frameRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+PhaseStatistics computePhaseStatistics(const std::vector<FramePhaseTimes> &frames, float FramePhaseTimes::*phase)
+{
+    std::vector<float> samples;
+    samples.reserve(frames.size());
+    for (const FramePhaseTimes &frame : frames)
+        if (frame.*phase >= 0.0f)
+            samples.push_back(frame.*phase);
+
+    if (samples.empty())
+        return {};
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    return {
+        .mean = std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size(),
+        .p50 = percentile(0.50),
+        .p95 = percentile(0.95),
+        .p99 = percentile(0.99),
+        .p999 = percentile(0.999),
+        .max = samples.back(),
+        .samples = samples.size(),
+    };
+}
+
+void setGpuTimes(FramePhaseTimes &frame, const GpuFrameTimes &gpuTimes)
+{
+    frame.gpu = gpuTimes.get(GpuScope::Frame) * 1000.0f;
+    frame.gpuCopy = gpuTimes.get(GpuScope::TransformCopy) * 1000.0f;
+    frame.gpuCull = gpuTimes.get(GpuScope::Cull) * 1000.0f;
+    frame.gpuPass = gpuTimes.get(GpuScope::RenderPass) * 1000.0f;
+    frame.gpuPresent = gpuTimes.get(GpuScope::PresentBarrier) * 1000.0f;
+}
+
+FrameRecorder::FrameRecorder(size_t capacity, float hitchThreshold)
+    : entries(std::max<size_t>(capacity, 1)), hitchThreshold(hitchThreshold)
+{
+}
+
+void FrameRecorder::record(uint64_t frameNumber, const FramePhaseTimes &frame)
+{
+    entries[recordedCount % entries.size()] = {.frameNumber = frameNumber, .times = frame};
+    recordedCount++;
+
+    if (frame.frame <= hitchThreshold)
+        return;
+
+    hitchCount++;
+    SPDLOG_WARN("[Frame stats] Hitch in frame {}: {:.2f} ms (update {:.2f}, wait {:.2f}, upload {:.2f}, record {:.2f}, "
+                "submit {:.2f}, present {:.2f})",
+                frameNumber, frame.frame, frame.update, frame.wait, frame.upload, frame.record, frame.submit,
+                frame.present);
+}
+
+/**
+ * \brief Store GPU times of a retired frame in its entry.
+ *
+ * Frame numbers grow with the entries, so the search walks back from the newest entry and stops at an older frame.
+ */
+void FrameRecorder::addGpuFrame(const GpuFrameTimes &gpuTimes)
+{
+    size_t count = std::min(recordedCount, entries.size());
+    for (size_t i = 1; i <= count; ++i)
+    {
+        Entry &entry = entries[(recordedCount - i) % entries.size()];
+        if (entry.frameNumber == gpuTimes.frameNumber)
+            setGpuTimes(entry.times, gpuTimes);
+        if (entry.frameNumber <= gpuTimes.frameNumber)
+            return;
+    }
+}
+
+std::vector<FramePhaseTimes> FrameRecorder::getFrames() const
+{
+    size_t count = std::min(recordedCount, entries.size());
+
+    std::vector<FramePhaseTimes> frames;
+    frames.reserve(count);
+    for (size_t i = recordedCount - count; i < recordedCount; ++i)
+        frames.push_back(entries[i % entries.size()].times);
+
+    return frames;
+}
+
+size_t FrameRecorder::getHitchCount() const
+{
+    return hitchCount;
+}
+
+/**
+ * \brief Log percentiles of the frame time and GPU time, the 1% low FPS and the number of hitches.
+ */
+void FrameRecorder::logSummary() const
+{
+    std::vector<FramePhaseTimes> frames = getFrames();
+    if (frames.empty())
+        return;
+
+    std::vector<float> frameTimes;
+    frameTimes.reserve(frames.size());
+    for (const FramePhaseTimes &frame : frames)
+        frameTimes.push_back(frame.frame);
+
+    // Average of the slowest 1% of frames, at least one frame
+    size_t lowCount = std::max<size_t>(frameTimes.size() / 100, 1);
+    std::partial_sort(frameTimes.begin(), frameTimes.begin() + lowCount, frameTimes.end(), std::greater<float>());
+    float lowMean = std::accumulate(frameTimes.begin(), frameTimes.begin() + lowCount, 0.0f) / lowCount;
+
+    SPDLOG_INFO("[Frame stats] Last {} frames, {} hitches over {:.1f} ms since start, 1% low {:.1f} FPS", frames.size(),
+                hitchCount, hitchThreshold, lowMean > 0.0f ? 1000.0f / lowMean : 0.0f);
+
+    auto logPhase = [&](const char *name, float FramePhaseTimes::*phase) {
+        PhaseStatistics statistics = computePhaseStatistics(frames, phase);
+        if (statistics.samples == 0)
+            return;
+
+        SPDLOG_INFO("[Frame stats] {:>3}: mean {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, p99.9 {:.3f} ms, "
+                    "max {:.3f} ms",
+                    name, statistics.mean, statistics.p50, statistics.p95, statistics.p99, statistics.p999,
+                    statistics.max);
+    };
+
+    logPhase("CPU", &FramePhaseTimes::frame);
+    logPhase("GPU", &FramePhaseTimes::gpu);
+}
+
+/**
+ * \brief Write one CSV row per recorded frame with all phases, and the histogram of the whole frame time.
+ *
+ * Unmeasured phases are left empty. Histogram buckets are histogramBucketWidth wide and cover every frame up to the
+ * slowest one, empty buckets included, so the file plots as is. Frames from histogramRange on, e.g. a window drag or
+ * a breakpoint, are counted in a last overflow bucket instead of adding a row per empty bucket up to them.
+ */
+void FrameRecorder::exportCsv(const std::string &fileName) const
+{
+    std::vector<FramePhaseTimes> frames = getFrames();
+
+    std::ofstream framesFile(fileName, std::ios::trunc);
+    if (!framesFile.is_open())
+        throw std::runtime_error(std::format("[Frame stats] Failed to open file {}", fileName));
+
+    framesFile << "index";
+    for (const auto &[phaseName, phase] : framePhases)
+        framesFile << ',' << phaseName << "_ms";
+    framesFile << '\n';
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        framesFile << i;
+        for (const auto &[phaseName, phase] : framePhases)
+            framesFile << ',' << (frames[i].*phase >= 0.0f ? std::format("{:.4f}", frames[i].*phase) : "");
+        framesFile << '\n';
+    }
+
+    std::filesystem::path histogramPath(fileName);
+    histogramPath.replace_filename(histogramPath.stem().string() + "_histogram" + histogramPath.extension().string());
+
+    std::ofstream histogramFile(histogramPath, std::ios::trunc);
+    if (!histogramFile.is_open())
+        throw std::runtime_error(std::format("[Frame stats] Failed to open file {}", histogramPath.string()));
+
+    constexpr size_t bucketCount = static_cast<size_t>(histogramRange / histogramBucketWidth);
+
+    std::vector<size_t> buckets;
+    size_t overflowFrames = 0;
+    for (const FramePhaseTimes &frame : frames)
+    {
+        if (frame.frame < 0.0f)
+            continue;
+
+        size_t bucket = static_cast<size_t>(frame.frame / histogramBucketWidth);
+        if (bucket >= bucketCount)
+        {
+            overflowFrames++;
+            continue;
+        }
+
+        if (bucket >= buckets.size())
+            buckets.resize(bucket + 1, 0);
+        buckets[bucket]++;
+    }
+
+    histogramFile << "frame_ms,frames\n";
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket)
+        histogramFile << std::format("{:.1f},{}\n", bucket * histogramBucketWidth, buckets[bucket]);
+    if (overflowFrames > 0)
+        histogramFile << std::format("{:.1f}+,{}\n", histogramRange, overflowFrames);
+
+    SPDLOG_INFO("[Frame stats] {} frames written to {}, histogram to {}", frames.size(), fileName, histogramPath.string());
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../types.h"
+
+/**
+ * \brief CPU phases and GPU time of one frame in milliseconds, negative if the phase was not measured.
+ */
+struct FramePhaseTimes
+{
+    float update{-1.0f};     // Scene update and camera path
+    float wait{-1.0f};       // Renderer waiting for the GPU to release the frame's resources
+    float upload{-1.0f};     // Transform matrices and uniforms
+    float record{-1.0f};     // Command buffer recording
+    float submit{-1.0f};     // Graphics queue submission
+    float present{-1.0f};    // Swapchain image acquisition and presentation
+    float frame{-1.0f};      // Whole frame on the CPU
+    float gpu{-1.0f};        // Whole graphics command buffer on the GPU
+    float gpuCopy{-1.0f};    // Transform matrices copy on the transfer queue
+    float gpuCull{-1.0f};    // Culling compute pass, GPU-driven rendering only
+    float gpuPass{-1.0f};    // Render pass with all draws
+    float gpuPresent{-1.0f}; // Present barrier, dynamic rendering only
+};
+
+// Name of every phase in reports and exports, in the order of FramePhaseTimes
+inline constexpr std::array<std::pair<const char *, float FramePhaseTimes::*>, 12> framePhases = {{
+    {"update", &FramePhaseTimes::update},
+    {"wait", &FramePhaseTimes::wait},
+    {"upload", &FramePhaseTimes::upload},
+    {"record", &FramePhaseTimes::record},
+    {"submit", &FramePhaseTimes::submit},
+    {"present", &FramePhaseTimes::present},
+    {"frame", &FramePhaseTimes::frame},
+    {"gpu", &FramePhaseTimes::gpu},
+    {"gpuCopy", &FramePhaseTimes::gpuCopy},
+    {"gpuCull", &FramePhaseTimes::gpuCull},
+    {"gpuPass", &FramePhaseTimes::gpuPass},
+    {"gpuPresent", &FramePhaseTimes::gpuPresent},
+}};
+
+struct PhaseStatistics
+{
+    float mean{0.0f};
+    float p50{0.0f};
+    float p95{0.0f};
+    float p99{0.0f};
+    float p999{0.0f};
+    float max{0.0f};
+    size_t samples{0};
+};
+
+//! Statistics of the measured samples of one phase, percentiles use the nearest rank
+PhaseStatistics computePhaseStatistics(const std::vector<FramePhaseTimes> &frames, float FramePhaseTimes::*phase);
+
+//! Copy GPU times of a retired frame into its phases, scopes the frame did not record stay negative
+void setGpuTimes(FramePhaseTimes &frame, const GpuFrameTimes &gpuTimes);
+
+/**
+ * \brief Timings of the latest frames in a fixed-size ring buffer, with percentiles, hitch detection and CSV export.
+ *
+ * Averages hide stutters, so the recorder keeps every frame of the window and reports the tail of the distribution:
+ * p95/p99/p99.9 frame time and the 1% low FPS, the average FPS of the slowest 1% of frames. Frames slower than the
+ * hitch threshold are logged with their phases when recorded. GPU times arrive when the renderer retires the frame,
+ * a few frames after it was recorded, and are matched by the renderer's frame number.
+ */
+class FrameRecorder
+{
+  public:
+    FrameRecorder(size_t capacity, float hitchThreshold);
+
+    void record(uint64_t frameNumber, const FramePhaseTimes &frame); //!< CPU phases of a submitted frame
+    void addGpuFrame(const GpuFrameTimes &gpuTimes); //!< Ignored once the frame has left the ring buffer
+
+    std::vector<FramePhaseTimes> getFrames() const; //!< Recorded frames oldest first
+    size_t getHitchCount() const;                   //!< Hitches since the recorder was created
+
+    void logSummary() const;
+    //! Write every recorded frame to a CSV file and a frame time histogram next to it, <name>_histogram.csv
+    void exportCsv(const std::string &fileName) const;
+
+  private:
+    static constexpr uint64_t noFrame = UINT64_MAX;
+    static constexpr float histogramBucketWidth = 0.5f; // Milliseconds
+    static constexpr float histogramRange = 250.0f;     // Milliseconds, slower frames share one overflow bucket
+
+    struct Entry
+    {
+        uint64_t frameNumber{noFrame};
+        FramePhaseTimes times;
+    };
+
+    std::vector<Entry> entries;
+    size_t recordedCount{0}; // Next entry written is recordedCount % capacity
+    float hitchThreshold;    // Milliseconds of the whole frame on the CPU
+    size_t hitchCount{0};
+};
@@ -0,0 +1,190 @@
+#include "gltfMesh.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <stdexcept>
+
+#pragma warning(push)
+#pragma warning(disable : 26451 26495 26819)
+#include <fastgltf/glm_element_traits.hpp>
+#include <fastgltf/tools.hpp>
+#pragma warning(pop)
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <tracy/Tracy.hpp>
+
+bool GltfMesh::isGltfFile(const std::string &fileName)
+{
+    std::string extension = std::filesystem::path(fileName).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    return extension == ".gltf" || extension == ".glb";
+}
+
+void GltfMesh::parse(const std::string &fileName, uint32_t meshId)
+{
+    ZoneScoped;
+
+    const std::filesystem::path path(fileName);
+
+    auto data = fastgltf::MappedGltfFile::FromPath(path);
+    if (data.error() != fastgltf::Error::None)
+    {
+        SPDLOG_ERROR("[Assets] Failed to open model {}. Error: {}", fileName, fastgltf::getErrorMessage(data.error()));
+        throw std::runtime_error("IO error");
+    }
+    gltfFile = std::make_unique<fastgltf::MappedGltfFile>(std::move(data.get()));
+
+    // External buffers are mapped by mapBuffers(), not read into vectors by the parser
+    fastgltf::Parser parser;
+    auto loaded = parser.loadGltf(*gltfFile, path.parent_path(), fastgltf::Options::None, fastgltf::Category::OnlyRenderable);
+    if (loaded.error() != fastgltf::Error::None)
+    {
+        SPDLOG_ERROR("[Assets] Failed to load model {}. Error: {}", fileName, fastgltf::getErrorMessage(loaded.error()));
+        throw std::runtime_error("IO error");
+    }
+
+    asset = std::move(loaded.get());
+    if (meshId >= asset.meshes.size())
+    {
+        SPDLOG_ERROR("[Assets] Model {} has no mesh {}", fileName, meshId);
+        throw std::runtime_error("IO error");
+    }
+
+    meshIndex = meshId;
+    vertexCount = 0;
+    indexCount = 0;
+
+    for (const auto &primitive : asset.meshes[meshIndex].primitives)
+    {
+        auto position = primitive.findAttribute("POSITION");
+        if (primitive.type != fastgltf::PrimitiveType::Triangles || position == primitive.attributes.end())
+            continue;
+
+        size_t primitiveVertices = asset.accessors[position->accessorIndex].count;
+        vertexCount += static_cast<uint32_t>(primitiveVertices);
+        indexCount += static_cast<uint32_t>(primitive.indicesAccessor.has_value()
+                                                ? asset.accessors[primitive.indicesAccessor.value()].count
+                                                : primitiveVertices);
+    }
+
+    mapBuffers(path.parent_path());
+
+    SPDLOG_INFO("[Assets] Loaded {} model. Meshes: {}, vertices: {}", fileName, asset.meshes.size(), vertexCount);
+}
+
+uint32_t GltfMesh::getVertexCount() const
+{
+    return vertexCount;
+}
+
+uint32_t GltfMesh::getIndexCount() const
+{
+    return indexCount;
+}
+
+template <typename Index>
+void GltfMesh::copy(std::span<glm::vec3> vertices, std::span<glm::vec3> normals, std::span<Index> indices) const
+{
+    ZoneScoped;
+
+    auto adapter = [this](const fastgltf::Asset &, size_t bufferViewIndex) {
+        std::span<const std::byte> view = getBufferView(bufferViewIndex);
+        return fastgltf::span<const std::byte>(view.data(), view.size());
+    };
+
+    size_t firstVertex = 0;
+    size_t firstIndex = 0;
+
+    for (const auto &primitive : asset.meshes[meshIndex].primitives)
+    {
+        auto position = primitive.findAttribute("POSITION");
+        if (primitive.type != fastgltf::PrimitiveType::Triangles || position == primitive.attributes.end())
+            continue;
+
+        const auto &positionAccessor = asset.accessors[position->accessorIndex];
+        fastgltf::copyFromAccessor<glm::vec3>(asset, positionAccessor, vertices.data() + firstVertex, adapter);
+
+        if (auto normal = primitive.findAttribute("NORMAL"); normal != primitive.attributes.end())
+            fastgltf::copyFromAccessor<glm::vec3>(asset, asset.accessors[normal->accessorIndex], normals.data() + firstVertex,
+                                                  adapter);
+        else
+            std::fill_n(normals.begin() + firstVertex, positionAccessor.count, glm::vec3(0.0f));
+
+        size_t primitiveIndices = positionAccessor.count;
+        Index *primitiveIndexData = indices.data() + firstIndex;
+
+        if (primitive.indicesAccessor.has_value())
+        {
+            const auto &indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+            primitiveIndices = indexAccessor.count;
+            fastgltf::copyFromAccessor<Index>(asset, indexAccessor, primitiveIndexData, adapter);
+        }
+        else
+        {
+            std::iota(primitiveIndexData, primitiveIndexData + primitiveIndices, Index{0});
+        }
+
+        // glTF triangles are counter-clockwise, the renderer expects the winding Assimp produces with
+        // aiProcess_FlipWindingOrder
+        for (size_t i = 0; i + 2 < primitiveIndices; i += 3)
+            std::swap(primitiveIndexData[i + 1], primitiveIndexData[i + 2]);
+
+        if (firstVertex > 0)
+        {
+            for (size_t i = 0; i < primitiveIndices; i++)
+                primitiveIndexData[i] = static_cast<Index>(primitiveIndexData[i] + firstVertex);
+        }
+
+        firstVertex += positionAccessor.count;
+        firstIndex += primitiveIndices;
+    }
+}
+
+template void GltfMesh::copy(std::span<glm::vec3>, std::span<glm::vec3>, std::span<glm::u16>) const;
+template void GltfMesh::copy(std::span<glm::vec3>, std::span<glm::vec3>, std::span<glm::u32>) const;
+
+/**
+ * \brief Resolve data of every buffer, buffers stored in separate files are memory mapped.
+ */
+void GltfMesh::mapBuffers(const std::filesystem::path &directory)
+{
+    externalBuffers.clear();
+    externalBuffers.resize(asset.buffers.size());
+    bufferData.assign(asset.buffers.size(), {});
+
+    for (size_t i = 0; i < asset.buffers.size(); i++)
+    {
+        std::visit(fastgltf::visitor{
+                       [&](const fastgltf::sources::URI &uri) {
+                           std::string bufferFile = (directory / uri.uri.fspath()).string();
+                           if (!uri.uri.isLocalPath() || !externalBuffers[i].open(bufferFile))
+                           {
+                               SPDLOG_ERROR("[Assets] Failed to map glTF buffer {}", bufferFile);
+                               throw std::runtime_error("IO error");
+                           }
+
+                           bufferData[i] = std::span(reinterpret_cast<const std::byte *>(externalBuffers[i].data()),
+                                                     externalBuffers[i].size())
+                                               .subspan(uri.fileByteOffset);
+                       },
+                       [&](const fastgltf::sources::Array &array) { bufferData[i] = {array.bytes.data(), array.bytes.size()}; },
+                       [&](const fastgltf::sources::Vector &vector) {
+                           bufferData[i] = {vector.bytes.data(), vector.bytes.size()};
+                       },
+                       [&](const fastgltf::sources::ByteView &view) { bufferData[i] = {view.bytes.data(), view.bytes.size()}; },
+                       [&](const auto &) { SPDLOG_WARN("[Assets] Unsupported source of glTF buffer {}", i); },
+                   },
+                   asset.buffers[i].data);
+    }
+}
+
+std::span<const std::byte> GltfMesh::getBufferView(size_t bufferViewIndex) const
+{
+    const auto &bufferView = asset.bufferViews[bufferViewIndex];
+    return bufferData[bufferView.bufferIndex].subspan(bufferView.byteOffset, bufferView.byteLength);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable : 26451 26495 26819)
+#include <fastgltf/core.hpp>
+#pragma warning(pop)
+
+#include <glm/glm.hpp>
+
+#include "mappedFile.h"
+
+/**
+ * \brief One mesh of a glTF 2.0 file (.gltf or .glb) loaded with fastgltf.
+ *
+ * parse() reads the JSON and maps external buffers, copy() converts accessor data straight from the mapped buffers
+ * into caller memory, usually lumps reserved in the MeshRegistry, so no geometry goes through intermediate vectors.
+ * Triangle primitives of the mesh are merged into one mesh.
+ */
+class GltfMesh
+{
+  public:
+    static bool isGltfFile(const std::string &fileName); //!< true for .gltf and .glb extension
+
+    void parse(const std::string &fileName, uint32_t meshId); //!< Throws on IO, parse or unsupported mesh errors
+
+    uint32_t getVertexCount() const;
+    uint32_t getIndexCount() const;
+
+    /**
+     * \brief Copy geometry of the mesh, spans have to hold getVertexCount() vertices and getIndexCount() indices.
+     *
+     * Index is glm::u16 or glm::u32, 16-bit indices require at most 65536 vertices.
+     */
+    template <typename Index>
+    void copy(std::span<glm::vec3> vertices, std::span<glm::vec3> normals, std::span<Index> indices) const;
+
+  private:
+    std::unique_ptr<fastgltf::MappedGltfFile> gltfFile; //!< Embedded .glb buffers may point into the mapping
+    fastgltf::Asset asset;
+    size_t meshIndex{0};
+    uint32_t vertexCount{0};
+    uint32_t indexCount{0};
+
+    std::vector<MappedFile> externalBuffers;            //!< Mapped .bin files referenced by URI
+    std::vector<std::span<const std::byte>> bufferData; //!< Data of every buffer of the asset
+
+    void mapBuffers(const std::filesystem::path &directory);
+    std::span<const std::byte> getBufferView(size_t bufferViewIndex) const;
+};
@@ -0,0 +1,178 @@
+#include "jobSystem.h"
+
+// Index of the queue owned by the current thread. Threads not created by the job system use queue 0.
+static thread_local uint32_t currentQueueIndex = 0;
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    queues.resize(threadCount);
+    for (auto &queue : queues)
+        queue = std::make_unique<WorkerQueue>();
+
+    workers.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i)
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+
+    SPDLOG_TRACE("[Job system] Created with {} threads", threadCount);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+
+    SPDLOG_TRACE("[Job system] Destroyed");
+}
+
+uint32_t JobSystem::getThreadCount() const
+{
+    return static_cast<uint32_t>(queues.size());
+}
+
+void JobSystem::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)> &func)
+{
+    if (count == 0)
+        return;
+
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    // Nothing to share - skip queueing overhead
+    if (chunkCount == 1 || queues.size() == 1)
+    {
+        ZoneScopedN("Job");
+        func(0, count);
+        return;
+    }
+
+    std::atomic<size_t> remaining{chunkCount};
+    std::exception_ptr exception; // First exception thrown by a chunk
+    std::mutex exceptionMutex;
+
+    // Distribute chunks round-robin so that workers start on their own queues instead of stealing right away
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        size_t begin = chunk * chunkSize;
+        size_t end = std::min(begin + chunkSize, count);
+
+        push(*queues[chunk % queues.size()], [&func, &remaining, &exception, &exceptionMutex, begin, end]() {
+            // The chunk counts as done even if it throws, otherwise the calling thread would wait forever
+            try
+            {
+                func(begin, end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_all();
+
+    // Help with the work instead of blocking
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!tryRunJob(currentQueueIndex, false))
+            std::this_thread::yield();
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+uint32_t JobSystem::getCurrentQueueIndex()
+{
+    return currentQueueIndex;
+}
+
+void JobSystem::push(WorkerQueue &queue, Job &&job)
+{
+    // Counted before the job becomes visible, so a thread taking it right away can't make the counter underflow
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queuedJobs.fetch_add(1, std::memory_order_release);
+    queue.jobs.push_back(std::move(job));
+}
+
+/**
+ * \brief Run a single job from own queue or steal one from other queues.
+ *
+ * Background jobs come last, only when takeBackground is set and no other job is queued.
+ *
+ * \return true if a job was executed
+ */
+bool JobSystem::tryRunJob(uint32_t index, bool takeBackground)
+{
+    Job job;
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (!queues[index]->jobs.empty())
+        {
+            job = std::move(queues[index]->jobs.back());
+            queues[index]->jobs.pop_back();
+        }
+    }
+
+    for (size_t i = 1; !job && i < queues.size(); ++i)
+    {
+        auto &victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+        }
+    }
+
+    if (!job && takeBackground)
+    {
+        std::lock_guard<std::mutex> lock(backgroundJobs.mutex);
+        if (!backgroundJobs.jobs.empty())
+        {
+            job = std::move(backgroundJobs.jobs.front());
+            backgroundJobs.jobs.pop_front();
+        }
+    }
+
+    if (!job)
+        return false;
+
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+    ZoneScopedN("Job");
+    job();
+    return true;
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+    currentQueueIndex = index;
+
+    while (true)
+    {
+        if (tryRunJob(index, true))
+            continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+
+        if (stopping && queuedJobs.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
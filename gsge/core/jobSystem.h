@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <tracy/Tracy.hpp>
+
+/**
+ * \brief Work-stealing job system.
+ *
+ * Every thread owns a deque of jobs. A thread pops jobs from the back of its own deque and steals from the front
+ * of the other deques when its own one runs dry. The thread waiting for a batch of jobs helps executing them,
+ * so the calling thread is counted as one of the threads and a job system created with one thread runs
+ * everything inline.
+ */
+class JobSystem
+{
+  public:
+    using Job = std::function<void()>;
+
+    static constexpr size_t cacheLineSize = 64;
+
+    JobSystem(uint32_t threadCount = 0); //!< 0 uses all hardware threads
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    ~JobSystem();
+
+    uint32_t getThreadCount() const; //!< Number of threads executing jobs, including the calling thread
+
+    /**
+     * \brief Split [0, count) into chunks and run func(begin, end) for every chunk in parallel.
+     *
+     * Returns once all chunks are processed. The calling thread executes chunks as well. If func throws, the
+     * remaining chunks still run and the first exception is rethrown on the calling thread.
+     */
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)> &func);
+
+    /**
+     * \brief Queue func to run on any thread and return a future of its result.
+     *
+     * Exceptions thrown by func are stored in the future. A job system with one thread has no workers, its jobs run
+     * only inside wait().
+     */
+    template <typename Func> auto submit(Func &&func) -> std::future<std::invoke_result_t<Func>>
+    {
+        return enqueue(*queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()], std::forward<Func>(func));
+    }
+
+    /**
+     * \brief Queue long running func, e.g. a pipeline compilation, and return a future of its result.
+     *
+     * Background jobs are taken only by workers out of other jobs and by wait(), never by a thread helping in
+     * parallelFor(), so they can't hold up the frame of the thread owning the job system. A job system with one
+     * thread runs them only inside wait().
+     */
+    template <typename Func> auto submitBackground(Func &&func) -> std::future<std::invoke_result_t<Func>>
+    {
+        return enqueue(backgroundJobs, std::forward<Func>(func));
+    }
+
+    /**
+     * \brief Run queued jobs until the future is ready, instead of blocking the calling thread.
+     */
+    template <typename Future> void wait(const Future &future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if (!tryRunJob(getCurrentQueueIndex(), true))
+                std::this_thread::yield();
+        }
+    }
+
+    /**
+     * \brief Smallest multiple of minElements whose byte size is a whole number of cache lines.
+     *
+     * Chunks of this size never let two threads write into the same cache line of a tightly packed array.
+     */
+    static constexpr size_t alignedChunkSize(size_t elementSize, size_t minElements)
+    {
+        size_t elementsPerLine = std::lcm(elementSize, cacheLineSize) / elementSize;
+        return ((minElements + elementsPerLine - 1) / elementsPerLine) * elementsPerLine;
+    }
+
+  private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues; // queues[0] belongs to the thread that owns the job system
+    WorkerQueue backgroundJobs;                        // Never stolen, see submitBackground()
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> queuedJobs{0};
+    std::atomic<size_t> nextQueue{0}; // Round-robin queue for submitted jobs
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool stopping{false};
+
+    template <typename Func> auto enqueue(WorkerQueue &queue, Func &&func) -> std::future<std::invoke_result_t<Func>>
+    {
+        using Result = std::invoke_result_t<Func>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        std::future<Result> future = task->get_future();
+
+        push(queue, [task]() { (*task)(); });
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeCondition.notify_one();
+
+        return future;
+    }
+
+    void workerLoop(uint32_t index);
+    void push(WorkerQueue &queue, Job &&job);
+    bool tryRunJob(uint32_t index, bool takeBackground);
+    static uint32_t getCurrentQueueIndex();
+};
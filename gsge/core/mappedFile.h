@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Read-only memory mapping of a whole file.
+ *
+ * Pages are loaded by the OS on first access, so data can be handed to consumers without reading it into a buffer.
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile();
+
+    bool open(const std::string &fileName); //!< false if the file does not exist, is empty or cannot be mapped
+    void close();
+
+    bool isOpen() const;
+    const uint8_t *data() const;
+    size_t size() const;
+
+  private:
+    const uint8_t *view{nullptr};
+    size_t viewSize{0};
+#if defined(_WIN32)
+    void *fileHandle{nullptr};
+    void *mappingHandle{nullptr};
+#endif
+};
@@ -0,0 +1,148 @@
+#include "meshCache.h"
+
+#include <filesystem>
+#include <fstream>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <tracy/Tracy.hpp>
+
+namespace meshCache
+{
+static constexpr const char *cacheDirectory = "cache";
+
+static size_t alignSection(size_t offset)
+{
+    return (offset + 15) & ~size_t{15};
+}
+
+uint64_t hashFile(const std::string &fileName)
+{
+    ZoneScoped;
+
+    MappedFile file;
+    if (!file.open(fileName))
+        return 0;
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const uint8_t *data = file.data();
+    for (size_t i = 0; i < file.size(); i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+std::string getCachePath(const std::string &fileName, uint32_t meshId)
+{
+    return (std::filesystem::path(cacheDirectory) / (fileName + "." + std::to_string(meshId) + ".gsmesh")).string();
+}
+
+bool load(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t meshId, CookedMesh &mesh)
+{
+    ZoneScoped;
+
+    if (!mesh.file.open(cachePath))
+        return false;
+
+    if (mesh.file.size() < sizeof(Header))
+    {
+        SPDLOG_WARN("[Mesh cache] {} is truncated", cachePath);
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(mesh.file.data());
+    if (header->magic != magic || header->version != version || header->sourceHash != sourceHash ||
+        header->importFlags != importFlags || header->meshId != meshId || header->indexType >= IndexType::Count)
+    {
+        SPDLOG_DEBUG("[Mesh cache] {} is stale", cachePath);
+        return false;
+    }
+
+    size_t normalOffset = alignSection(sizeof(Header) + header->vertexCount * sizeof(glm::vec3));
+    size_t indexOffset = alignSection(normalOffset + header->vertexCount * sizeof(glm::vec3));
+    size_t indexSize = header->indexType == IndexType::Uint16 ? sizeof(glm::u16) : sizeof(glm::u32);
+    if (mesh.file.size() < indexOffset + header->indexCount * indexSize)
+    {
+        SPDLOG_WARN("[Mesh cache] {} is truncated", cachePath);
+        return false;
+    }
+
+    const uint8_t *data = mesh.file.data();
+    mesh.boundingSphere = header->boundingSphere;
+    mesh.vertices = {reinterpret_cast<const glm::vec3 *>(data + sizeof(Header)), header->vertexCount};
+    mesh.normals = {reinterpret_cast<const glm::vec3 *>(data + normalOffset), header->vertexCount};
+    if (header->indexType == IndexType::Uint16)
+        mesh.indices16 = {reinterpret_cast<const glm::u16 *>(data + indexOffset), header->indexCount};
+    else
+        mesh.indices32 = {reinterpret_cast<const glm::u32 *>(data + indexOffset), header->indexCount};
+
+    return true;
+}
+
+bool write(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t meshId,
+           const glm::vec4 &boundingSphere, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+           IndexType indexType, std::span<const std::byte> indices)
+{
+    ZoneScoped;
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+
+    // Written next to the target and renamed, so a concurrent or interrupted write never leaves a partial file behind
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            SPDLOG_WARN("[Mesh cache] Failed to create {}", tempPath);
+            return false;
+        }
+
+        Header header{
+            .magic = magic,
+            .version = version,
+            .sourceHash = sourceHash,
+            .importFlags = importFlags,
+            .meshId = meshId,
+            .vertexCount = static_cast<uint32_t>(vertices.size()),
+            .indexCount = static_cast<uint32_t>(indices.size() / (indexType == IndexType::Uint16 ? sizeof(glm::u16)
+                                                                                                  : sizeof(glm::u32))),
+            .boundingSphere = boundingSphere,
+            .indexType = indexType,
+            .reserved = {},
+        };
+
+        const char padding[16] = {};
+        size_t offset = sizeof(Header) + vertices.size_bytes();
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(vertices.data()), vertices.size_bytes());
+        file.write(padding, alignSection(offset) - offset);
+        offset = alignSection(offset) + normals.size_bytes();
+        file.write(reinterpret_cast<const char *>(normals.data()), normals.size_bytes());
+        file.write(padding, alignSection(offset) - offset);
+        file.write(reinterpret_cast<const char *>(indices.data()), indices.size_bytes());
+
+        if (!file)
+        {
+            SPDLOG_WARN("[Mesh cache] Failed to write {}", tempPath);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error)
+    {
+        SPDLOG_WARN("[Mesh cache] Failed to rename {}: {}", tempPath, error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    SPDLOG_DEBUG("[Mesh cache] Cooked {}", cachePath);
+    return true;
+}
+} // namespace meshCache
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "../types.h"
+#include "mappedFile.h"
+
+/**
+ * \brief Cooked binary copies of imported meshes, so warm starts skip Assimp.
+ *
+ * File layout: Header, positions, normals, indices of the mesh index type, tightly packed. Every section starts at a 16-byte aligned offset,
+ * so a mapped file is consumed in place. A cooked mesh is stale when its version, import flags or the hash of the
+ * source model file do not match, stale files are overwritten on the next import.
+ */
+namespace meshCache
+{
+constexpr uint32_t magic = 0x434D5347; //!< "GSMC"
+constexpr uint32_t version = 2;        //!< Bump on any layout change
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;    //!< FNV-1a of the source model file
+    uint32_t importFlags;   //!< Assimp post processing flags the mesh was imported with
+    uint32_t meshId;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    glm::vec4 boundingSphere; //!< xyz - center in model space, w - radius
+    IndexType indexType;
+    uint32_t reserved[3];
+};
+static_assert(sizeof(Header) == 64);
+
+struct CookedMesh
+{
+    MappedFile file;
+    glm::vec4 boundingSphere;
+    std::span<const glm::vec3> vertices; //!< Points into file, valid while file is open
+    std::span<const glm::vec3> normals;
+    std::span<const glm::u16> indices16; //!< Empty unless the mesh has 16-bit indices
+    std::span<const glm::u32> indices32; //!< Empty unless the mesh has 32-bit indices
+};
+
+uint64_t hashFile(const std::string &fileName); //!< 0 if the file cannot be read
+std::string getCachePath(const std::string &fileName, uint32_t meshId);
+
+bool load(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t meshId, CookedMesh &mesh);
+bool write(const std::string &cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t meshId,
+           const glm::vec4 &boundingSphere, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+           IndexType indexType, std::span<const std::byte> indices);
+} // namespace meshCache
@@ -0,0 +1,179 @@
+#include "meshRegistry.h"
+
+MeshHandle MeshRegistry::add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                             std::span<const glm::u32> indices)
+{
+    if (MeshHandle existing = find(name); existing != invalidMeshHandle)
+        return existing;
+
+    return addConverted(name, vertices, normals, indices, computeBoundingSphere(vertices));
+}
+
+MeshHandle MeshRegistry::add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                             std::span<const glm::u32> indices, const glm::vec4 &boundingSphere)
+{
+    return addConverted(name, vertices, normals, indices, boundingSphere);
+}
+
+MeshHandle MeshRegistry::add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                             std::span<const glm::u16> indices, const glm::vec4 &boundingSphere)
+{
+    return addConverted(name, vertices, normals, indices, boundingSphere);
+}
+
+template <typename Index>
+MeshHandle MeshRegistry::addConverted(const std::string &name, std::span<const glm::vec3> vertices,
+                                      std::span<const glm::vec3> normals, std::span<const Index> indices,
+                                      const glm::vec4 &boundingSphere)
+{
+    if (MeshHandle existing = find(name); existing != invalidMeshHandle)
+        return existing;
+
+    MeshAllocation allocation =
+        allocate(name, static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(indices.size()));
+
+    std::copy(vertices.begin(), vertices.end(), allocation.vertices.begin());
+    std::copy(normals.begin(), normals.end(), allocation.normals.begin());
+    if (allocation.indexType == IndexType::Uint16)
+        std::transform(indices.begin(), indices.end(), allocation.indices16.begin(),
+                       [](Index index) { return static_cast<glm::u16>(index); });
+    else
+        std::copy(indices.begin(), indices.end(), allocation.indices32.begin());
+    setBoundingSphere(allocation.handle, boundingSphere);
+
+    return allocation.handle;
+}
+
+MeshAllocation MeshRegistry::allocate(const std::string &name, uint32_t vertexCount, uint32_t indexCount)
+{
+    if (MeshHandle existing = find(name); existing != invalidMeshHandle)
+        return {.handle = existing, .indexType = meshes[existing].indexType};
+
+    IndexType indexType = selectIndexType(vertexCount);
+    uint32_t firstIndex =
+        static_cast<uint32_t>(indexType == IndexType::Uint16 ? indexLump16.size() : indexLump32.size());
+
+    MeshInfo info{
+        .firstIndex = firstIndex,
+        .indexCount = indexCount,
+        .indexType = indexType,
+        .vertexOffset = static_cast<int32_t>(vertexLump.size()),
+        .vertexCount = vertexCount,
+        .boundingSphere = glm::vec4(0.0f),
+    };
+
+    vertexLump.resize(vertexLump.size() + vertexCount);
+    normalLump.resize(normalLump.size() + vertexCount);
+
+    MeshAllocation allocation{
+        .handle = static_cast<MeshHandle>(meshes.size()),
+        .vertices = std::span(vertexLump).subspan(info.vertexOffset, vertexCount),
+        .normals = std::span(normalLump).subspan(info.vertexOffset, vertexCount),
+        .indexType = indexType,
+    };
+
+    if (indexType == IndexType::Uint16)
+    {
+        indexLump16.resize(indexLump16.size() + indexCount);
+        allocation.indices16 = std::span(indexLump16).subspan(firstIndex, indexCount);
+    }
+    else
+    {
+        indexLump32.resize(indexLump32.size() + indexCount);
+        allocation.indices32 = std::span(indexLump32).subspan(firstIndex, indexCount);
+    }
+
+    meshes.push_back(info);
+    handles.emplace(name, allocation.handle);
+
+    SPDLOG_TRACE("[Mesh registry] Added {} as mesh {}, vertices: {}, indices: {} ({}-bit)", name, allocation.handle,
+                 info.vertexCount, info.indexCount, indexType == IndexType::Uint16 ? 16 : 32);
+    return allocation;
+}
+
+void MeshRegistry::setBoundingSphere(MeshHandle handle, const glm::vec4 &boundingSphere)
+{
+    meshes[handle].boundingSphere = boundingSphere;
+}
+
+glm::vec4 MeshRegistry::computeBoundingSphere(std::span<const glm::vec3> vertices)
+{
+    if (vertices.empty())
+        return glm::vec4(0.0f);
+
+    glm::vec3 minCorner = vertices.front();
+    glm::vec3 maxCorner = vertices.front();
+    for (const auto &vertex : vertices)
+    {
+        minCorner = glm::min(minCorner, vertex);
+        maxCorner = glm::max(maxCorner, vertex);
+    }
+
+    glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+    float radius = 0.0f;
+    for (const auto &vertex : vertices)
+        radius = std::max(radius, glm::length(vertex - center));
+
+    return glm::vec4(center, radius);
+}
+
+IndexType MeshRegistry::selectIndexType(size_t vertexCount)
+{
+    return vertexCount <= size_t{std::numeric_limits<glm::u16>::max()} + 1 ? IndexType::Uint16 : IndexType::Uint32;
+}
+
+MeshHandle MeshRegistry::find(const std::string &name) const
+{
+    auto it = handles.find(name);
+    return it != handles.end() ? it->second : invalidMeshHandle;
+}
+
+const MeshInfo &MeshRegistry::get(MeshHandle handle) const
+{
+    return meshes[handle];
+}
+
+size_t MeshRegistry::size() const
+{
+    return meshes.size();
+}
+
+std::vector<glm::vec3> &MeshRegistry::getVertexLump()
+{
+    return vertexLump;
+}
+
+std::vector<glm::vec3> &MeshRegistry::getNormalLump()
+{
+    return normalLump;
+}
+
+std::vector<glm::u16> &MeshRegistry::getIndexLump16()
+{
+    return indexLump16;
+}
+
+std::vector<glm::u32> &MeshRegistry::getIndexLump32()
+{
+    return indexLump32;
+}
+
+const std::vector<glm::vec3> &MeshRegistry::getVertexLump() const
+{
+    return vertexLump;
+}
+
+const std::vector<glm::vec3> &MeshRegistry::getNormalLump() const
+{
+    return normalLump;
+}
+
+const std::vector<glm::u16> &MeshRegistry::getIndexLump16() const
+{
+    return indexLump16;
+}
+
+const std::vector<glm::u32> &MeshRegistry::getIndexLump32() const
+{
+    return indexLump32;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <glm/glm.hpp>
+
+#include "../types.h"
+
+/**
+ * \brief Geometry of one unique mesh inside the registry lumps.
+ */
+struct MeshInfo
+{
+    uint32_t firstIndex;      //!< First index in the index lump of indexType
+    uint32_t indexCount;
+    IndexType indexType;
+    int32_t vertexOffset;     //!< First vertex in the vertex and normal lumps, added to every index
+    uint32_t vertexCount;
+    glm::vec4 boundingSphere; //!< xyz - center in model space, w - radius
+};
+
+/**
+ * \brief Lump ranges reserved for a new mesh, filled in place by the caller.
+ */
+struct MeshAllocation
+{
+    MeshHandle handle;
+    std::span<glm::vec3> vertices; //!< Valid until the next mesh is added
+    std::span<glm::vec3> normals;
+    IndexType indexType;
+    std::span<glm::u16> indices16; //!< Relative to the first vertex of the mesh, empty unless indexType is Uint16
+    std::span<glm::u32> indices32; //!< Relative to the first vertex of the mesh, empty unless indexType is Uint32
+};
+
+/**
+ * \brief Storage of unique meshes.
+ *
+ * Vertices, normals and indices of every mesh are appended once to shared lumps, which are uploaded to the GPU as they
+ * are. Every mesh gets the narrowest index type its vertex count allows, 16-bit and 32-bit indices are kept in separate
+ * lumps. Entities reference meshes by handle (component::mesh), so any number of entities drawing the same mesh costs
+ * no extra geometry and they can be drawn with one instanced draw.
+ */
+class MeshRegistry
+{
+  public:
+    /**
+     * \brief Add mesh under a name, e.g. file name and mesh index. Returns handle of the existing mesh if the name is taken.
+     *
+     * Indices are converted to the index type selected by selectIndexType().
+     */
+    MeshHandle add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                   std::span<const glm::u32> indices);
+    MeshHandle add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                   std::span<const glm::u32> indices, const glm::vec4 &boundingSphere); //!< Bounds known, e.g. cooked mesh
+    MeshHandle add(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                   std::span<const glm::u16> indices, const glm::vec4 &boundingSphere);
+    /**
+     * \brief Reserve lump ranges for a mesh, so loaders can write geometry straight into the lumps.
+     *
+     * Index type is selected by selectIndexType(). Bounding sphere of the mesh stays empty until setBoundingSphere().
+     * Returns the existing handle and empty ranges if the name is taken.
+     */
+    MeshAllocation allocate(const std::string &name, uint32_t vertexCount, uint32_t indexCount);
+    void setBoundingSphere(MeshHandle handle, const glm::vec4 &boundingSphere);
+    MeshHandle find(const std::string &name) const; //!< invalidMeshHandle if no mesh has the name
+    const MeshInfo &get(MeshHandle handle) const;
+    size_t size() const;
+
+    static glm::vec4 computeBoundingSphere(std::span<const glm::vec3> vertices); //!< Sphere around the bounding box center
+    static IndexType selectIndexType(size_t vertexCount); //!< Uint16 when every vertex is addressable with 16 bits
+
+    std::vector<glm::vec3> &getVertexLump();
+    std::vector<glm::vec3> &getNormalLump();
+    std::vector<glm::u16> &getIndexLump16();
+    std::vector<glm::u32> &getIndexLump32();
+    const std::vector<glm::vec3> &getVertexLump() const;
+    const std::vector<glm::vec3> &getNormalLump() const;
+    const std::vector<glm::u16> &getIndexLump16() const;
+    const std::vector<glm::u32> &getIndexLump32() const;
+
+  private:
+    std::vector<MeshInfo> meshes;
+    std::unordered_map<std::string, MeshHandle> handles;
+
+    std::vector<glm::vec3> vertexLump;
+    std::vector<glm::vec3> normalLump;
+    std::vector<glm::u16> indexLump16;
+    std::vector<glm::u32> indexLump32;
+
+    template <typename Index>
+    MeshHandle addConverted(const std::string &name, std::span<const glm::vec3> vertices, std::span<const glm::vec3> normals,
+                            std::span<const Index> indices, const glm::vec4 &boundingSphere);
+};
@@ -1,11 +1,19 @@
 #include "stats.h"
 
+#include <format>
+#include <string>
+
 void stats::update()
 {
     frameNumber++;
 
     dt = frameTime.resetTimer();
-    if (totalRunningTime.getTimeAsSeconds()<2) return;
+    if (totalRunningTime.getTimeAsSeconds() < 2)
+    {
+        gpuTimeSums = {};
+        gpuTimeCounts = {};
+        return;
+    }
     
     averageFrameTimeCounter++;
     totalFrameTimeCounter += dt;
@@ -20,8 +28,31 @@ void stats::update()
 
         SPDLOG_INFO("FPS {:.1f}\tMIN {:.1f}\tMAX {:.1f}", currentFps, minFps, maxFps);
 
+        std::string gpuTimes;
+        for (size_t scope = 0; scope < gpuScopeCount; ++scope)
+            if (gpuTimeCounts[scope] > 0)
+                gpuTimes += std::format("\t{} {:.3f} ms", getName(static_cast<GpuScope>(scope)),
+                                        gpuTimeSums[scope] / gpuTimeCounts[scope] * 1000.0f);
+        if (!gpuTimes.empty())
+            SPDLOG_INFO("GPU{}", gpuTimes);
+
+        gpuTimeSums = {};
+        gpuTimeCounts = {};
+
         averageFrameTimeCounter = 0;
         totalFrameTimeCounter = 0;
         averageFrameCountNumber = 1 + static_cast<size_t>(currentFps);
     }
 }
+
+void stats::addGpuFrame(const GpuFrameTimes &frameTimes)
+{
+    for (size_t scope = 0; scope < gpuScopeCount; ++scope)
+    {
+        if (frameTimes.scopes[scope] < 0.0f)
+            continue;
+
+        gpuTimeSums[scope] += frameTimes.scopes[scope];
+        gpuTimeCounts[scope]++;
+    }
+}
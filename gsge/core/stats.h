@@ -1,13 +1,16 @@
 #pragma once
 
+#include <array>
 #include <limits>
 
 #include "../timer.h"
+#include "../types.h"
 
 class stats
 {
   public:
     void update();
+    void addGpuFrame(const GpuFrameTimes &frameTimes); //!< GPU times are averaged over the same frames as FPS
 
     float dt = 0.0f;
 
@@ -22,6 +25,11 @@ class stats
     size_t frameNumber{0};
 
   private:
+    static constexpr size_t gpuScopeCount = static_cast<size_t>(GpuScope::Count);
+
+    std::array<float, gpuScopeCount> gpuTimeSums{};
+    std::array<size_t, gpuScopeCount> gpuTimeCounts{};
+
     timer frameTime;
     timer totalRunningTime;
 };
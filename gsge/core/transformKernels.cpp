@@ -0,0 +1,140 @@
+#include "transformKernels.h"
+
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace transformKernels
+{
+static constexpr float twoPi = 6.28318530717959f;
+static constexpr float invTwoPi = 0.159154943091895f;
+
+static inline float wrapAngle(float angle)
+{
+    return angle - twoPi * std::nearbyint(angle * invTwoPi);
+}
+
+void integrateScalar(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        float position[3];
+        float sinAngle[3];
+        float cosAngle[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            position[axis] = streams.position[axis][i] + streams.velocity[axis][i] * dt;
+            streams.position[axis][i] = position[axis];
+
+            float angle = wrapAngle(streams.rotation[axis][i] + streams.angularVelocity[axis][i] * dt);
+            streams.rotation[axis][i] = angle;
+            sinAngle[axis] = std::sin(angle);
+            cosAngle[axis] = std::cos(angle);
+        }
+
+        // x = pitch, y = yaw, z = roll, same convention as XMMatrixRotationRollPitchYaw
+        float sp = sinAngle[0], sy = sinAngle[1], sr = sinAngle[2];
+        float cp = cosAngle[0], cy = cosAngle[1], cr = cosAngle[2];
+        float scaleX = streams.scale[0][i], scaleY = streams.scale[1][i], scaleZ = streams.scale[2][i];
+
+        float *m = matrices + i * 16;
+        m[0] = (cr * cy + sr * sp * sy) * scaleX;
+        m[1] = sr * cp * scaleY;
+        m[2] = (sr * sp * cy - cr * sy) * scaleZ;
+        m[3] = 0.0f;
+        m[4] = (cr * sp * sy - sr * cy) * scaleX;
+        m[5] = cr * cp * scaleY;
+        m[6] = (sr * sy + cr * sp * cy) * scaleZ;
+        m[7] = 0.0f;
+        m[8] = cp * sy * scaleX;
+        m[9] = -sp * scaleY;
+        m[10] = cp * cy * scaleZ;
+        m[11] = 0.0f;
+        m[12] = position[0];
+        m[13] = position[1];
+        m[14] = position[2];
+        m[15] = 1.0f;
+    }
+}
+
+bool isSupported(Isa isa)
+{
+    if (isa == Isa::Scalar)
+        return true;
+
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    if (maxLeaf < 7)
+        return false;
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || !fma)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool avx512f = (info[1] & (1 << 16)) != 0;
+
+    // The OS has to save YMM (and ZMM/opmask) registers on context switch
+    unsigned long long xcr0 = _xgetbv(0);
+    bool ymmState = (xcr0 & 0x6) == 0x6;
+    bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+    if (isa == Isa::Avx2)
+        return avx2 && ymmState;
+    return avx512f && avx2 && zmmState;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+    if (isa == Isa::Avx2)
+        return avx2;
+    return avx2 && __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+Isa bestSupported()
+{
+    if (isSupported(Isa::Avx512))
+        return Isa::Avx512;
+    if (isSupported(Isa::Avx2))
+        return Isa::Avx2;
+    return Isa::Scalar;
+}
+
+IntegrateKernel get(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Avx512:
+        return integrateAvx512;
+    case Isa::Avx2:
+        return integrateAvx2;
+    default:
+        return integrateScalar;
+    }
+}
+
+const char *getName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Avx512:
+        return "AVX-512";
+    case Isa::Avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+} // namespace transformKernels
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Functions using wider instruction sets are compiled for their target only, the rest of the program keeps the
+// baseline architecture. MSVC accepts AVX intrinsics without /arch, GCC and Clang need the target attribute.
+#if defined(__GNUC__) || defined(__clang__)
+#define GSGE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GSGE_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define GSGE_TARGET_AVX2
+#define GSGE_TARGET_AVX512
+#endif
+
+/**
+ * \brief Pointers to structure-of-arrays transform streams, one float per entity in every stream.
+ */
+struct TransformStreams
+{
+    float *position[3];              //!< x, y, z in units
+    float *rotation[3];              //!< Pitch, yaw, roll in radians
+    const float *scale[3];           //!< x, y, z
+    const float *velocity[3];        //!< Units/s
+    const float *angularVelocity[3]; //!< Radians/s
+};
+
+/**
+ * \brief Batch kernels integrating motion and building 4x4 transform matrices.
+ *
+ * Every kernel integrates entities [begin, end), wraps rotations to [-pi, pi] and writes one row-major matrix
+ * (16 floats, DirectXMath layout: rotation * scale, translation in the last row) per entity to matrices[i * 16].
+ * Vector kernels process 8 (AVX2) or 16 (AVX-512) entities at a time and fall back to scalar code for the tail.
+ */
+namespace transformKernels
+{
+enum class Isa : uint32_t
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+using IntegrateKernel = void (*)(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices);
+
+void integrateScalar(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices);
+void integrateAvx2(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices);
+void integrateAvx512(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices);
+
+bool isSupported(Isa isa); //!< Checks both CPU and OS support of the instruction set
+Isa bestSupported();       //!< Widest instruction set supported on the machine
+IntegrateKernel get(Isa isa);
+const char *getName(Isa isa);
+} // namespace transformKernels
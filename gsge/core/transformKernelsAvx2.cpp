@@ -0,0 +1,155 @@
+#include "transformKernels.h"
+
+#include <immintrin.h>
+
+namespace transformKernels
+{
+/**
+ * \brief Sine and cosine of 8 angles in [-pi, pi].
+ *
+ * Angles are reduced to [-pi/4, pi/4] by subtracting multiples of a three-part pi/2 (Cody-Waite) and evaluated with
+ * minimax polynomials, then swapped and negated according to the quadrant. Max error is around 1 ulp in the reduced range.
+ */
+GSGE_TARGET_AVX2 static inline void sinCos8(__m256 x, __m256 &sinResult, __m256 &cosResult)
+{
+    const __m256 twoOverPi = _mm256_set1_ps(0.636619772367581f);
+
+    __m256 j = _mm256_round_ps(_mm256_mul_ps(x, twoOverPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256i quadrant = _mm256_cvtps_epi32(j);
+
+    __m256 y = _mm256_fnmadd_ps(j, _mm256_set1_ps(1.5703125f), x);
+    y = _mm256_fnmadd_ps(j, _mm256_set1_ps(4.837512969970703125e-4f), y);
+    y = _mm256_fnmadd_ps(j, _mm256_set1_ps(7.54978995489188216e-8f), y);
+    __m256 z = _mm256_mul_ps(y, y);
+
+    __m256 sinPoly = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), z, _mm256_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm256_fmadd_ps(sinPoly, z, _mm256_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm256_fmadd_ps(_mm256_mul_ps(sinPoly, z), y, y);
+
+    __m256 cosPoly = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), z, _mm256_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm256_fmadd_ps(cosPoly, z, _mm256_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+    cosPoly = _mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)), cosPoly);
+
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+    __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+    __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+    sinResult = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, swap), sinSign);
+    cosResult = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, swap), cosSign);
+}
+
+/**
+ * \brief Transpose 8 rows of 8 floats, so that component streams become per-entity matrix rows.
+ */
+GSGE_TARGET_AVX2 static inline void transpose8x8(__m256 r[8])
+{
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, 0xee);
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, 0xee);
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, 0xee);
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, 0xee);
+
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+GSGE_TARGET_AVX2 void integrateAvx2(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices)
+{
+    constexpr size_t width = 8;
+
+    const __m256 dtVec = _mm256_set1_ps(dt);
+    const __m256 twoPi = _mm256_set1_ps(6.28318530717959f);
+    const __m256 invTwoPi = _mm256_set1_ps(0.159154943091895f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = begin;
+    for (; i + width <= end; i += width)
+    {
+        __m256 position[3];
+        __m256 sinAngle[3];
+        __m256 cosAngle[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            position[axis] =
+                _mm256_fmadd_ps(_mm256_loadu_ps(streams.velocity[axis] + i), dtVec, _mm256_loadu_ps(streams.position[axis] + i));
+            _mm256_storeu_ps(streams.position[axis] + i, position[axis]);
+
+            __m256 angle = _mm256_fmadd_ps(_mm256_loadu_ps(streams.angularVelocity[axis] + i), dtVec,
+                                           _mm256_loadu_ps(streams.rotation[axis] + i));
+            __m256 turns = _mm256_round_ps(_mm256_mul_ps(angle, invTwoPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            angle = _mm256_fnmadd_ps(turns, twoPi, angle);
+            _mm256_storeu_ps(streams.rotation[axis] + i, angle);
+
+            sinCos8(angle, sinAngle[axis], cosAngle[axis]);
+        }
+
+        // x = pitch, y = yaw, z = roll, same convention as XMMatrixRotationRollPitchYaw
+        __m256 sp = sinAngle[0], sy = sinAngle[1], sr = sinAngle[2];
+        __m256 cp = cosAngle[0], cy = cosAngle[1], cr = cosAngle[2];
+        __m256 scaleX = _mm256_loadu_ps(streams.scale[0] + i);
+        __m256 scaleY = _mm256_loadu_ps(streams.scale[1] + i);
+        __m256 scaleZ = _mm256_loadu_ps(streams.scale[2] + i);
+
+        __m256 srsp = _mm256_mul_ps(sr, sp);
+        __m256 crsp = _mm256_mul_ps(cr, sp);
+
+        // Rows 0-1 and rows 2-3 of 8 matrices, one matrix element per register
+        __m256 upper[8] = {
+            _mm256_mul_ps(_mm256_fmadd_ps(srsp, sy, _mm256_mul_ps(cr, cy)), scaleX),
+            _mm256_mul_ps(_mm256_mul_ps(sr, cp), scaleY),
+            _mm256_mul_ps(_mm256_fmsub_ps(srsp, cy, _mm256_mul_ps(cr, sy)), scaleZ),
+            zero,
+            _mm256_mul_ps(_mm256_fmsub_ps(crsp, sy, _mm256_mul_ps(sr, cy)), scaleX),
+            _mm256_mul_ps(_mm256_mul_ps(cr, cp), scaleY),
+            _mm256_mul_ps(_mm256_fmadd_ps(crsp, cy, _mm256_mul_ps(sr, sy)), scaleZ),
+            zero,
+        };
+        __m256 lower[8] = {
+            _mm256_mul_ps(_mm256_mul_ps(cp, sy), scaleX),
+            _mm256_mul_ps(_mm256_sub_ps(zero, sp), scaleY),
+            _mm256_mul_ps(_mm256_mul_ps(cp, cy), scaleZ),
+            zero,
+            position[0],
+            position[1],
+            position[2],
+            one,
+        };
+
+        transpose8x8(upper);
+        transpose8x8(lower);
+
+        float *m = matrices + i * 16;
+        for (size_t entity = 0; entity < width; ++entity)
+        {
+            _mm256_storeu_ps(m + entity * 16, upper[entity]);
+            _mm256_storeu_ps(m + entity * 16 + 8, lower[entity]);
+        }
+    }
+
+    integrateScalar(streams, i, end, dt, matrices);
+}
+} // namespace transformKernels
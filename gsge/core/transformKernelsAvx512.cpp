@@ -0,0 +1,153 @@
+#include "transformKernels.h"
+
+#include <immintrin.h>
+
+namespace transformKernels
+{
+/**
+ * \brief Sine and cosine of 16 angles in [-pi, pi], see sinCos8 in the AVX2 kernel.
+ */
+GSGE_TARGET_AVX512 static inline void sinCos16(__m512 x, __m512 &sinResult, __m512 &cosResult)
+{
+    const __m512 twoOverPi = _mm512_set1_ps(0.636619772367581f);
+
+    __m512 j = _mm512_roundscale_ps(_mm512_mul_ps(x, twoOverPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512i quadrant = _mm512_cvtps_epi32(j);
+
+    __m512 y = _mm512_fnmadd_ps(j, _mm512_set1_ps(1.5703125f), x);
+    y = _mm512_fnmadd_ps(j, _mm512_set1_ps(4.837512969970703125e-4f), y);
+    y = _mm512_fnmadd_ps(j, _mm512_set1_ps(7.54978995489188216e-8f), y);
+    __m512 z = _mm512_mul_ps(y, y);
+
+    __m512 sinPoly = _mm512_fmadd_ps(_mm512_set1_ps(-1.9515295891e-4f), z, _mm512_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm512_fmadd_ps(sinPoly, z, _mm512_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm512_fmadd_ps(_mm512_mul_ps(sinPoly, z), y, y);
+
+    __m512 cosPoly = _mm512_fmadd_ps(_mm512_set1_ps(2.443315711809948e-5f), z, _mm512_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm512_fmadd_ps(cosPoly, z, _mm512_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm512_mul_ps(_mm512_mul_ps(cosPoly, z), z);
+    cosPoly = _mm512_add_ps(_mm512_fnmadd_ps(_mm512_set1_ps(0.5f), z, _mm512_set1_ps(1.0f)), cosPoly);
+
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i two = _mm512_set1_epi32(2);
+
+    __mmask16 swap = _mm512_test_epi32_mask(quadrant, one);
+    __m512i sinSign = _mm512_slli_epi32(_mm512_and_si512(quadrant, two), 30);
+    __m512i cosSign = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(quadrant, one), two), 30);
+
+    __m512 sinSwapped = _mm512_mask_blend_ps(swap, sinPoly, cosPoly);
+    __m512 cosSwapped = _mm512_mask_blend_ps(swap, cosPoly, sinPoly);
+
+    sinResult = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(sinSwapped), sinSign));
+    cosResult = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(cosSwapped), cosSign));
+}
+
+/**
+ * \brief Transpose 16 rows of 16 floats, so that matrix element streams become per-entity matrices.
+ */
+GSGE_TARGET_AVX512 static inline void transpose16x16(__m512 r[16])
+{
+    __m512 t[16];
+    for (int i = 0; i < 8; ++i)
+    {
+        t[2 * i] = _mm512_unpacklo_ps(r[2 * i], r[2 * i + 1]);
+        t[2 * i + 1] = _mm512_unpackhi_ps(r[2 * i], r[2 * i + 1]);
+    }
+
+    // Every 128-bit lane l of u[4 * i + k] now holds rows 4i..4i+3 of column 4l+k
+    __m512 u[16];
+    for (int i = 0; i < 4; ++i)
+    {
+        u[4 * i] = _mm512_shuffle_ps(t[4 * i], t[4 * i + 2], 0x44);
+        u[4 * i + 1] = _mm512_shuffle_ps(t[4 * i], t[4 * i + 2], 0xee);
+        u[4 * i + 2] = _mm512_shuffle_ps(t[4 * i + 1], t[4 * i + 3], 0x44);
+        u[4 * i + 3] = _mm512_shuffle_ps(t[4 * i + 1], t[4 * i + 3], 0xee);
+    }
+
+    // Gather lane l of u[k], u[4 + k], u[8 + k], u[12 + k] into column 4l+k
+    for (int k = 0; k < 4; ++k)
+    {
+        __m512 evenLow = _mm512_shuffle_f32x4(u[k], u[4 + k], 0x88);
+        __m512 oddLow = _mm512_shuffle_f32x4(u[k], u[4 + k], 0xdd);
+        __m512 evenHigh = _mm512_shuffle_f32x4(u[8 + k], u[12 + k], 0x88);
+        __m512 oddHigh = _mm512_shuffle_f32x4(u[8 + k], u[12 + k], 0xdd);
+
+        r[k] = _mm512_shuffle_f32x4(evenLow, evenHigh, 0x88);
+        r[4 + k] = _mm512_shuffle_f32x4(oddLow, oddHigh, 0x88);
+        r[8 + k] = _mm512_shuffle_f32x4(evenLow, evenHigh, 0xdd);
+        r[12 + k] = _mm512_shuffle_f32x4(oddLow, oddHigh, 0xdd);
+    }
+}
+
+GSGE_TARGET_AVX512 void integrateAvx512(const TransformStreams &streams, size_t begin, size_t end, float dt, float *matrices)
+{
+    constexpr size_t width = 16;
+
+    const __m512 dtVec = _mm512_set1_ps(dt);
+    const __m512 twoPi = _mm512_set1_ps(6.28318530717959f);
+    const __m512 invTwoPi = _mm512_set1_ps(0.159154943091895f);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+
+    size_t i = begin;
+    for (; i + width <= end; i += width)
+    {
+        __m512 position[3];
+        __m512 sinAngle[3];
+        __m512 cosAngle[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            position[axis] =
+                _mm512_fmadd_ps(_mm512_loadu_ps(streams.velocity[axis] + i), dtVec, _mm512_loadu_ps(streams.position[axis] + i));
+            _mm512_storeu_ps(streams.position[axis] + i, position[axis]);
+
+            __m512 angle = _mm512_fmadd_ps(_mm512_loadu_ps(streams.angularVelocity[axis] + i), dtVec,
+                                           _mm512_loadu_ps(streams.rotation[axis] + i));
+            __m512 turns = _mm512_roundscale_ps(_mm512_mul_ps(angle, invTwoPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            angle = _mm512_fnmadd_ps(turns, twoPi, angle);
+            _mm512_storeu_ps(streams.rotation[axis] + i, angle);
+
+            sinCos16(angle, sinAngle[axis], cosAngle[axis]);
+        }
+
+        // x = pitch, y = yaw, z = roll, same convention as XMMatrixRotationRollPitchYaw
+        __m512 sp = sinAngle[0], sy = sinAngle[1], sr = sinAngle[2];
+        __m512 cp = cosAngle[0], cy = cosAngle[1], cr = cosAngle[2];
+        __m512 scaleX = _mm512_loadu_ps(streams.scale[0] + i);
+        __m512 scaleY = _mm512_loadu_ps(streams.scale[1] + i);
+        __m512 scaleZ = _mm512_loadu_ps(streams.scale[2] + i);
+
+        __m512 srsp = _mm512_mul_ps(sr, sp);
+        __m512 crsp = _mm512_mul_ps(cr, sp);
+
+        // All 16 elements of 16 matrices, one matrix element per register
+        __m512 elements[16] = {
+            _mm512_mul_ps(_mm512_fmadd_ps(srsp, sy, _mm512_mul_ps(cr, cy)), scaleX),
+            _mm512_mul_ps(_mm512_mul_ps(sr, cp), scaleY),
+            _mm512_mul_ps(_mm512_fmsub_ps(srsp, cy, _mm512_mul_ps(cr, sy)), scaleZ),
+            zero,
+            _mm512_mul_ps(_mm512_fmsub_ps(crsp, sy, _mm512_mul_ps(sr, cy)), scaleX),
+            _mm512_mul_ps(_mm512_mul_ps(cr, cp), scaleY),
+            _mm512_mul_ps(_mm512_fmadd_ps(crsp, cy, _mm512_mul_ps(sr, sy)), scaleZ),
+            zero,
+            _mm512_mul_ps(_mm512_mul_ps(cp, sy), scaleX),
+            _mm512_mul_ps(_mm512_sub_ps(zero, sp), scaleY),
+            _mm512_mul_ps(_mm512_mul_ps(cp, cy), scaleZ),
+            zero,
+            position[0],
+            position[1],
+            position[2],
+            one,
+        };
+
+        transpose16x16(elements);
+
+        float *m = matrices + i * 16;
+        for (size_t entity = 0; entity < width; ++entity)
+            _mm512_storeu_ps(m + entity * 16, elements[entity]);
+    }
+
+    integrateScalar(streams, i, end, dt, matrices);
+}
+} // namespace transformKernels
@@ -0,0 +1,298 @@
+#include "transformPool.h"
+
+TransformPool::TransformPool()
+{
+    setKernel(transformKernels::bestSupported());
+}
+
+TransformPool::~TransformPool()
+{
+    allocate(0);
+}
+
+void TransformPool::allocate(size_t newCapacity)
+{
+    if (data != nullptr)
+        ::operator delete[](data, std::align_val_t{alignment});
+
+    data = nullptr;
+    capacity = newCapacity;
+
+    if (newCapacity > 0)
+        data = static_cast<float *>(::operator new[](newCapacity * StreamCount * sizeof(float), std::align_val_t{alignment}));
+}
+
+void TransformPool::build(entt::registry &registry, const std::vector<entt::entity> &entities)
+{
+    ZoneScoped;
+
+    count = entities.size();
+    allocate((count + batchSize - 1) / batchSize * batchSize);
+    slotEntities = entities;
+    dynamicSlots.assign(count, 0);
+    dirtySlots.assign(count, 1);
+    hasDirtySlots = true;
+    dynamicRangesOutdated = true;
+
+    // Padding slots are never integrated, but keep them deterministic
+    std::fill(data, data + capacity * StreamCount, 0.0f);
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        entt::entity entity = entities[slot];
+
+        const auto &transform = registry.get<component::transform>(entity);
+        const float position[3] = {transform.position.x, transform.position.y, transform.position.z};
+        const float rotation[3] = {transform.rotation.x, transform.rotation.y, transform.rotation.z};
+        const float scale[3] = {transform.scale.x, transform.scale.y, transform.scale.z};
+
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            getStream(static_cast<Stream>(PositionX + axis))[slot] = position[axis];
+            getStream(static_cast<Stream>(RotationX + axis))[slot] = rotation[axis];
+            getStream(static_cast<Stream>(ScaleX + axis))[slot] = scale[axis];
+        }
+
+        if (const auto *motion = registry.try_get<component::motion>(entity))
+        {
+            const float velocity[3] = {motion->velocity.x, motion->velocity.y, motion->velocity.z};
+            const float angularVelocity[3] = {motion->rotation.x, motion->rotation.y, motion->rotation.z};
+
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                getStream(static_cast<Stream>(VelocityX + axis))[slot] = velocity[axis];
+                getStream(static_cast<Stream>(AngularVelocityX + axis))[slot] = angularVelocity[axis];
+
+                if (velocity[axis] != 0.0f || angularVelocity[axis] != 0.0f)
+                    dynamicSlots[slot] = 1;
+            }
+        }
+    }
+
+    SPDLOG_TRACE("[Transform pool] Built with {} entities, {} kernel", count, transformKernels::getName(kernelIsa));
+}
+
+/**
+ * \brief Integrate motion of dynamic slots and write their transform matrices in parallel.
+ *
+ * Chunks are multiples of batchSize and whole cache lines of every stream, so vector kernels run without a scalar
+ * tail except at the ends of dynamic ranges and no two threads write the same cache line. Static slots are
+ * rebuilt only when marked dirty.
+ *
+ * \param matrices [out] Transform matrices indexed by slot
+ */
+void TransformPool::integrate(JobSystem &jobSystem, float dt, DirectX::XMMATRIX *matrices)
+{
+    constexpr size_t chunkSize = JobSystem::alignedChunkSize(sizeof(float), 1024);
+    static_assert(chunkSize % batchSize == 0);
+
+    if (dynamicRangesOutdated)
+        updateDynamicRanges();
+
+    TransformStreams streams = getStreams();
+    float *output = reinterpret_cast<float *>(matrices);
+    transformKernels::IntegrateKernel integrateKernel = kernel;
+
+    if (!dynamicRanges.empty() && !gpuIntegration)
+    {
+        jobSystem.parallelFor(count, chunkSize, [&](size_t begin, size_t end) {
+            // First dynamic range ending after the beginning of the chunk
+            auto range = std::upper_bound(dynamicRanges.begin(), dynamicRanges.end(), begin,
+                                          [](size_t slot, const DirtyRange &range) { return slot < range.first + range.count; });
+
+            for (; range != dynamicRanges.end() && range->first < end; ++range)
+            {
+                size_t rangeBegin = std::max<size_t>(begin, range->first);
+                size_t rangeEnd = std::min<size_t>(end, range->first + range->count);
+                integrateKernel(streams, rangeBegin, rangeEnd, dt, output);
+            }
+        });
+    }
+
+    if (hasDirtySlots)
+        rebuildDirtySlots(output);
+    else if (gpuIntegration)
+        dirtyRanges.clear();
+    else
+        dirtyRanges.assign(dynamicRanges.begin(), dynamicRanges.end());
+}
+
+void TransformPool::markDirty(size_t slot)
+{
+    dirtySlots[slot] = 1;
+    hasDirtySlots = true;
+}
+
+void TransformPool::setMotion(size_t slot, const DirectX::XMFLOAT3 &velocity, const DirectX::XMFLOAT3 &angularVelocity)
+{
+    getStream(VelocityX)[slot] = velocity.x;
+    getStream(VelocityY)[slot] = velocity.y;
+    getStream(VelocityZ)[slot] = velocity.z;
+    getStream(AngularVelocityX)[slot] = angularVelocity.x;
+    getStream(AngularVelocityY)[slot] = angularVelocity.y;
+    getStream(AngularVelocityZ)[slot] = angularVelocity.z;
+
+    uint8_t dynamic = (velocity.x != 0.0f || velocity.y != 0.0f || velocity.z != 0.0f || angularVelocity.x != 0.0f ||
+                       angularVelocity.y != 0.0f || angularVelocity.z != 0.0f);
+
+    if (dynamicSlots[slot] != dynamic)
+    {
+        dynamicSlots[slot] = dynamic;
+        dynamicRangesOutdated = true;
+    }
+
+    markDirty(slot);
+}
+
+const std::vector<DirtyRange> &TransformPool::getDirtyRanges() const
+{
+    return dirtyRanges;
+}
+
+void TransformPool::setGpuIntegration(bool enabled)
+{
+    gpuIntegration = enabled;
+}
+
+bool TransformPool::isGpuIntegrated() const
+{
+    return gpuIntegration;
+}
+
+/**
+ * \brief Gather streams of dynamic slots into motion states for the GPU, e.g. right after build().
+ */
+std::vector<MotionState> TransformPool::getMotionStates()
+{
+    std::vector<MotionState> states;
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        if (!dynamicSlots[slot])
+            continue;
+
+        states.push_back({
+            .position = {getStream(PositionX)[slot], getStream(PositionY)[slot], getStream(PositionZ)[slot]},
+            .transformIndex = static_cast<uint32_t>(slot),
+            .rotation = {getStream(RotationX)[slot], getStream(RotationY)[slot], getStream(RotationZ)[slot]},
+            .scale = {getStream(ScaleX)[slot], getStream(ScaleY)[slot], getStream(ScaleZ)[slot]},
+            .velocity = {getStream(VelocityX)[slot], getStream(VelocityY)[slot], getStream(VelocityZ)[slot]},
+            .angularVelocity = {getStream(AngularVelocityX)[slot], getStream(AngularVelocityY)[slot],
+                                getStream(AngularVelocityZ)[slot]},
+        });
+    }
+
+    return states;
+}
+
+void TransformPool::updateDynamicRanges()
+{
+    dynamicRanges.clear();
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        if (!dynamicSlots[slot])
+            continue;
+
+        if (!dynamicRanges.empty() && dynamicRanges.back().first + dynamicRanges.back().count == slot)
+            dynamicRanges.back().count++;
+        else
+            dynamicRanges.push_back({static_cast<uint32_t>(slot), 1});
+    }
+
+    dynamicRangesOutdated = false;
+
+    SPDLOG_TRACE("[Transform pool] {} dynamic ranges", dynamicRanges.size());
+}
+
+/**
+ * \brief Build matrices of static slots marked dirty and list all matrices written in this update.
+ */
+void TransformPool::rebuildDirtySlots(float *matrices)
+{
+    TransformStreams streams = getStreams();
+    dirtyRanges.clear();
+
+    size_t staticBegin = 0;
+    size_t staticCount = 0;
+
+    // Zero dt builds matrices of static slots without moving them
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        if (dirtySlots[slot] && !dynamicSlots[slot])
+        {
+            if (staticCount == 0)
+                staticBegin = slot;
+            staticCount++;
+        }
+        else if (staticCount > 0)
+        {
+            kernel(streams, staticBegin, staticBegin + staticCount, 0.0f, matrices);
+            staticCount = 0;
+        }
+
+        // Dynamic slots are written by integrate() unless the GPU integrates them
+        bool written = dynamicSlots[slot] ? !gpuIntegration : dirtySlots[slot] != 0;
+        if (!written)
+            continue;
+
+        if (!dirtyRanges.empty() && dirtyRanges.back().first + dirtyRanges.back().count == slot)
+            dirtyRanges.back().count++;
+        else
+            dirtyRanges.push_back({static_cast<uint32_t>(slot), 1});
+    }
+
+    if (staticCount > 0)
+        kernel(streams, staticBegin, staticBegin + staticCount, 0.0f, matrices);
+
+    std::fill(dirtySlots.begin(), dirtySlots.end(), uint8_t{0});
+    hasDirtySlots = false;
+}
+
+void TransformPool::setKernel(transformKernels::Isa isa)
+{
+    if (!transformKernels::isSupported(isa))
+    {
+        SPDLOG_WARN("[Transform pool] {} kernel is not supported on this CPU, using scalar kernel", transformKernels::getName(isa));
+        isa = transformKernels::Isa::Scalar;
+    }
+
+    kernelIsa = isa;
+    kernel = transformKernels::get(isa);
+}
+
+transformKernels::Isa TransformPool::getKernel() const
+{
+    return kernelIsa;
+}
+
+size_t TransformPool::size() const
+{
+    return count;
+}
+
+entt::entity TransformPool::getEntity(size_t slot) const
+{
+    return slotEntities[slot];
+}
+
+float *TransformPool::getStream(Stream stream)
+{
+    return data + stream * capacity;
+}
+
+TransformStreams TransformPool::getStreams()
+{
+    TransformStreams streams{};
+
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        streams.position[axis] = getStream(static_cast<Stream>(PositionX + axis));
+        streams.rotation[axis] = getStream(static_cast<Stream>(RotationX + axis));
+        streams.scale[axis] = getStream(static_cast<Stream>(ScaleX + axis));
+        streams.velocity[axis] = getStream(static_cast<Stream>(VelocityX + axis));
+        streams.angularVelocity[axis] = getStream(static_cast<Stream>(AngularVelocityX + axis));
+    }
+
+    return streams;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include <entt/entity/registry.hpp>
+
+#pragma warning(suppress : 4275 6285 26498 26451 26800)
+#include <spdlog/spdlog.h>
+
+#include <tracy/Tracy.hpp>
+
+#include "../component/transform.h"
+#include "../component/motion.h"
+#include "../types.h"
+#include "jobSystem.h"
+#include "transformKernels.h"
+
+/**
+ * \brief Structure-of-arrays storage of transforms and motions of the simulated entities.
+ *
+ * Every component of position, rotation, scale, velocity and angular velocity is kept in its own 64-byte aligned
+ * float stream, so batch kernels load 8 or 16 entities with a single instruction. Slot i of the pool produces
+ * matrix i, slots follow the order passed to build(). After build() the pool owns the simulation state,
+ * transform components keep the initial values only.
+ *
+ * Slots with zero velocity and angular velocity are static: their matrices are built once and integrate() skips them
+ * until they are marked dirty. getDirtyRanges() lists matrices written by the last integrate() call, so only those
+ * have to be uploaded to the GPU.
+ *
+ * With GPU integration dynamic slots are handed over to the renderer by getMotionStates() and never integrated or
+ * reported dirty again, integrate() only builds matrices of static slots.
+ */
+class TransformPool
+{
+  public:
+    enum Stream : uint32_t
+    {
+        PositionX,
+        PositionY,
+        PositionZ,
+        RotationX,
+        RotationY,
+        RotationZ,
+        ScaleX,
+        ScaleY,
+        ScaleZ,
+        VelocityX,
+        VelocityY,
+        VelocityZ,
+        AngularVelocityX,
+        AngularVelocityY,
+        AngularVelocityZ,
+        StreamCount
+    };
+
+    static constexpr size_t alignment = 64;
+    static constexpr size_t batchSize = 16; //!< Capacity granularity, width of the widest kernel
+
+    TransformPool();
+    TransformPool(const TransformPool &) = delete;
+    TransformPool &operator=(const TransformPool &) = delete;
+    ~TransformPool();
+
+    /**
+     * \brief Copy transform and motion components of entities into the pool, entities[i] goes to slot i.
+     *
+     * Entities without motion component are static.
+     */
+    void build(entt::registry &registry, const std::vector<entt::entity> &entities);
+    void integrate(JobSystem &jobSystem, float dt, DirectX::XMMATRIX *matrices);
+
+    void markDirty(size_t slot); //!< Rebuild and report matrix of the slot on next integrate(), e.g. after editing a stream
+    void setMotion(size_t slot, const DirectX::XMFLOAT3 &velocity, const DirectX::XMFLOAT3 &angularVelocity);
+    const std::vector<DirtyRange> &getDirtyRanges() const; //!< Sorted, non-overlapping ranges written by last integrate()
+
+    void setGpuIntegration(bool enabled);
+    bool isGpuIntegrated() const;
+    std::vector<MotionState> getMotionStates(); //!< Current state of dynamic slots, in slot order
+
+    void setKernel(transformKernels::Isa isa); //!< Force kernel, falls back to scalar when isa is not supported
+    transformKernels::Isa getKernel() const;
+
+    size_t size() const;
+    entt::entity getEntity(size_t slot) const;
+    float *getStream(Stream stream);
+
+  private:
+    float *data{nullptr};
+    size_t count{0};
+    size_t capacity{0}; //!< Stride between streams, multiple of batchSize
+    std::vector<entt::entity> slotEntities;
+
+    std::vector<uint8_t> dynamicSlots;     //!< 1 if slot has non-zero motion
+    std::vector<uint8_t> dirtySlots;       //!< 1 if slot has to be rebuilt on next integrate()
+    std::vector<DirtyRange> dynamicRanges; //!< Coalesced runs of dynamic slots
+    std::vector<DirtyRange> dirtyRanges;   //!< Matrices written by last integrate()
+    bool hasDirtySlots{false};
+    bool dynamicRangesOutdated{false};
+    bool gpuIntegration{false}; //!< Dynamic slots are integrated by the renderer
+
+    transformKernels::Isa kernelIsa{transformKernels::Isa::Scalar};
+    transformKernels::IntegrateKernel kernel{transformKernels::integrateScalar};
+
+    void allocate(size_t newCapacity);
+    void updateDynamicRanges();
+    void rebuildDirtySlots(float *matrices);
+    TransformStreams getStreams();
+};
@@ -7,6 +7,13 @@ enum class DisplayMode
     FullScreen,
     Windowed
 };
+
+enum class CameraPath
+{
+    Static,    // Fixed position outside the scene, looking at its center
+    Orbit,     // Circle around the scene, looking at its center
+    Flythrough // Straight line through the scene along its diagonal
+};
 } // namespace ESettings
 
 namespace EEngine
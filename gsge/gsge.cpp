@@ -1,22 +1,39 @@
 #include "gsge.h"
 
+#include <algorithm>
+#include <numeric>
+
 gsge::~gsge()
 {
 }
 
 void gsge::init()
 {
-    window = std::make_shared<Window>();
+    // Headless runs render offscreen, there is no window to poll input from
+    if (!settings.Headless.enabled)
+    {
+        window = std::make_shared<Window>();
 
-    window->createWindow();
-    window->setTitle("Giraffe Game Engine");
+        window->createWindow();
+        window->setTitle("Giraffe Game Engine");
+
+        mouse = std::make_unique<Mouse>(window);
+        frameRecorder = std::make_unique<FrameRecorder>(settings.FrameStats.historySize, settings.FrameStats.hitchThreshold);
+    }
 
-    mouse = std::make_unique<Mouse>(window);
-    renderer = std::make_unique<vulkan>(window);
+    jobSystem = std::make_shared<JobSystem>(settings.Jobs.threadCount);
+    SPDLOG_INFO("[Job system] Running on {} threads", jobSystem->getThreadCount());
 
-    level = std::make_unique<scene>();
-    level->initScene();
+    renderer = std::make_unique<vulkan>(window, jobSystem);
+
+    level = std::make_unique<scene>(jobSystem);
+    if (settings.BenchScene.enabled)
+        level->initBenchScene(settings.BenchScene.entityCount, settings.BenchScene.uniqueMeshCount,
+                              settings.BenchScene.motionFraction, settings.BenchScene.cameraPath);
+    else
+        level->initScene();
     level->prepareFrameData();
+    level->setGpuTransformIntegration(settings.Renderer.gpuTransforms);
     level->update(0.0f);
 
     uploadBuffersToGPU();
@@ -25,6 +42,9 @@ void gsge::init()
 
     level->mainCamera.setAspect(renderer->getViewAspect());
 
+    if (settings.Headless.enabled)
+        return;
+
     glfwSetWindowUserPointer(*window, this);
     glfwSetKeyCallback(*window, [](GLFWwindow *window, int key, int scancode, int action, int mods) {
         gsge *instance = reinterpret_cast<gsge *>(glfwGetWindowUserPointer(window));
@@ -71,6 +91,47 @@ void gsge::keyCallback(GLFWwindow *glfwWindow, int key, int scancode, int action
             renderer->handleMSAAChange();
         }
         break;
+    case GLFW_KEY_G:
+        if (action == GLFW_PRESS)
+        {
+            settings.Renderer.gpuDriven = !settings.Renderer.gpuDriven;
+            SPDLOG_INFO("GPU-driven rendering {}", settings.Renderer.gpuDriven ? "enabled" : "disabled");
+        }
+        break;
+    case GLFW_KEY_Y:
+        if (action == GLFW_PRESS)
+        {
+            settings.Renderer.dynamicRendering = !settings.Renderer.dynamicRendering;
+            renderer->handleRenderingModeChange();
+        }
+        break;
+    case GLFW_KEY_R:
+        if (action == GLFW_PRESS)
+        {
+            settings.Renderer.parallelRecording = !settings.Renderer.parallelRecording;
+            SPDLOG_INFO("Parallel draw recording {}", settings.Renderer.parallelRecording ? "enabled" : "disabled");
+        }
+        break;
+    case GLFW_KEY_V:
+        // Renderer keeps drawing with the current shaders until the pipeline of the other ones is built
+        if (action == GLFW_PRESS)
+            settings.Renderer.perVertexLighting = !settings.Renderer.perVertexLighting;
+        break;
+    case GLFW_KEY_L:
+        if (action == GLFW_PRESS)
+        {
+            settings.Renderer.framesInFlight = settings.Renderer.framesInFlight % 3 + 1;
+            renderer->handleFrameSettingsChange();
+        }
+        break;
+    case GLFW_KEY_I:
+        if (action == GLFW_PRESS)
+            renderer->logMemoryStats();
+        break;
+    case GLFW_KEY_H:
+        if (action == GLFW_PRESS)
+            reportFrameStats();
+        break;
     }
 }
 
@@ -81,18 +142,37 @@ void gsge::cleanup()
 void gsge::uploadBuffersToGPU()
 {
     renderer->prepareVertexData(level->getVertexLump().data(), level->getVertexLump().size());
-    renderer->prepareIndexData(level->getIndexLump().data(), level->getIndexLump().size());
+    renderer->prepareIndexData(level->getIndexLump16().data(), level->getIndexLump16().size());
+    renderer->prepareIndexData(level->getIndexLump32().data(), level->getIndexLump32().size());
     renderer->prepareNormalsData(level->getNormalLump().data(), level->getNormalLump().size());
-    renderer->prepareIndexOffsets(level->getIndexOffsets());
-    renderer->prepareVertexOffsets(level->getVertexOffsets());
+    renderer->prepareDrawGroups(level->getDrawGroups());
     renderer->pushTransformMatricesToGpu(level->getTransformMatricesLump());
+    renderer->prepareObjectCullData(level->getObjectCullLump());
+
+    if (settings.Renderer.gpuTransforms)
+        renderer->prepareMotionStates(level->getMotionStates());
 }
 
 void gsge::mainLoop()
 {
+    if (settings.BenchScene.enabled)
+    {
+        runBenchmark();
+        return;
+    }
+
+    if (settings.Headless.enabled)
+    {
+        runHeadless();
+        return;
+    }
+
+    // Frame time covers the whole iteration, event handling included, its update phase everything before the renderer
+    timer frameTimer;
     while (!glfwWindowShouldClose(*window))
     {
         ZoneScoped;
+        frameTimer.resetTimer();
         glfwPollEvents();
 
         mouse->update();
@@ -139,10 +219,239 @@ void gsge::mainLoop()
 
         level->update(frameStats.dt);
 
+        renderer->markTransformMatricesDirty(level->getDirtyTransformRanges());
+        renderer->setTransformIntegrationStep(frameStats.dt);
         renderer->updateUniformBufferEx(level->ubo);
+        float updateTime = frameTimer.getTimeAsSeconds();
+
+        // Renderer skips the frame while the window is resized or minimized, nothing is recorded then
+        uint64_t frameNumber = renderer->getSubmittedFrameCount();
         renderer->update();
 
+        if (renderer->getSubmittedFrameCount() != frameNumber)
+        {
+            const vulkan::FrameCpuTimes &cpuTimes = renderer->getFrameCpuTimes();
+            FramePhaseTimes frame{
+                .update = updateTime * 1000.0f,
+                .wait = cpuTimes.wait * 1000.0f,
+                .upload = cpuTimes.upload * 1000.0f,
+                .record = cpuTimes.record * 1000.0f,
+                .submit = cpuTimes.submit * 1000.0f,
+                .present = cpuTimes.present * 1000.0f,
+                .frame = frameTimer.getTimeAsSeconds() * 1000.0f,
+            };
+            frameRecorder->record(frameNumber, frame);
+        }
+
+        for (const GpuFrameTimes &frameTimes : renderer->getRetiredFrameTimings())
+        {
+            frameStats.addGpuFrame(frameTimes);
+            frameRecorder->addGpuFrame(frameTimes);
+        }
+
         if (renderer->viewAspectChanged())
             level->mainCamera.setAspect(renderer->getViewAspect());
     }
+
+    reportFrameStats();
+}
+
+/**
+ * \brief Log frame time percentiles of the recorded frames and export them with their histogram.
+ *
+ * Runs from the key callback as well, so a failed export is logged instead of thrown.
+ */
+void gsge::reportFrameStats()
+{
+    frameRecorder->logSummary();
+
+    try
+    {
+        frameRecorder->exportCsv(settings.FrameStats.outputPath);
+    }
+    catch (const std::exception &e)
+    {
+        SPDLOG_ERROR("{}", e.what());
+    }
+}
+
+/**
+ * \brief Render a fixed number of frames offscreen and log CPU and GPU time of every frame.
+ *
+ * Scene advances by a fixed timestep, so the last frame and the saved image are the same on every run.
+ */
+void gsge::runHeadless()
+{
+    constexpr float dt = 1.0f / 60.0f;
+    const uint32_t frameCount = settings.Headless.frameCount;
+
+    std::vector<float> cpuTimes(frameCount, 0.0f);
+    std::vector<float> gpuTimes(frameCount, -1.0f); // Negative until the frame's timestamps are read back
+
+    auto collectGpuTimes = [&]() {
+        for (const GpuFrameTimes &frameTimes : renderer->getRetiredFrameTimings())
+            if (frameTimes.frameNumber < frameCount)
+                gpuTimes[frameTimes.frameNumber] = frameTimes.get(GpuScope::Frame);
+    };
+
+    SPDLOG_INFO("[Headless] Rendering {} frames", frameCount);
+
+    timer frameTimer;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        ZoneScoped;
+        frameTimer.resetTimer();
+
+        level->update(dt);
+
+        renderer->markTransformMatricesDirty(level->getDirtyTransformRanges());
+        renderer->setTransformIntegrationStep(dt);
+        renderer->updateUniformBufferEx(level->ubo);
+        renderer->update();
+
+        cpuTimes[frame] = frameTimer.getTimeAsSeconds();
+        collectGpuTimes();
+    }
+
+    renderer->waitIdle();
+    collectGpuTimes();
+
+    float gpuTimeSum = 0.0f;
+    uint32_t gpuTimeCount = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        if (gpuTimes[frame] >= 0.0f)
+        {
+            SPDLOG_INFO("[Headless] Frame {}: CPU {:.3f} ms, GPU {:.3f} ms", frame, cpuTimes[frame] * 1000.0f,
+                        gpuTimes[frame] * 1000.0f);
+            gpuTimeSum += gpuTimes[frame];
+            ++gpuTimeCount;
+        }
+        else
+            SPDLOG_INFO("[Headless] Frame {}: CPU {:.3f} ms, GPU n/a", frame, cpuTimes[frame] * 1000.0f);
+    }
+
+    if (frameCount > 0)
+    {
+        auto [cpuMin, cpuMax] = std::minmax_element(cpuTimes.begin(), cpuTimes.end());
+        float cpuMean = std::accumulate(cpuTimes.begin(), cpuTimes.end(), 0.0f) / static_cast<float>(frameCount);
+        SPDLOG_INFO("[Headless] CPU frame time: mean {:.3f} ms, min {:.3f} ms, max {:.3f} ms", cpuMean * 1000.0f,
+                    *cpuMin * 1000.0f, *cpuMax * 1000.0f);
+    }
+
+    if (gpuTimeCount > 0)
+        SPDLOG_INFO("[Headless] GPU frame time: mean {:.3f} ms over {} frames", gpuTimeSum / gpuTimeCount * 1000.0f,
+                    gpuTimeCount);
+
+    if (!settings.Headless.imagePath.empty())
+        renderer->saveFrameImage(settings.Headless.imagePath);
+}
+
+/**
+ * \brief Render the bench scene with a fixed timestep and write frame time statistics to the report file.
+ *
+ * Camera follows the path of the bench scene. Warmup frames build pipelines and fill caches, they are rendered but
+ * left out of the statistics. Closing the window ends the run early, the report covers the frames measured so far.
+ */
+void gsge::runBenchmark()
+{
+    constexpr float dt = 1.0f / 60.0f;
+    constexpr uint32_t warmupFrames = 30;
+    const uint32_t frameCount = settings.Headless.frameCount;
+
+    std::vector<FramePhaseTimes> frames;
+    frames.reserve(frameCount);
+
+    // Renderer numbers submitted frames, iterations skipped on resize or minimize submit none. Warmup and measured
+    // frames are counted by those numbers, so measured frames are numbered consecutively from firstMeasuredFrame and
+    // GPU times retired later land on the right frame. Scopes not recorded stay negative
+    const uint64_t firstMeasuredFrame = renderer->getSubmittedFrameCount() + warmupFrames;
+    auto collectGpuTimes = [&]() {
+        for (const GpuFrameTimes &frameTimes : renderer->getRetiredFrameTimings())
+            if (frameTimes.frameNumber >= firstMeasuredFrame && frameTimes.frameNumber - firstMeasuredFrame < frames.size())
+                setGpuTimes(frames[frameTimes.frameNumber - firstMeasuredFrame], frameTimes);
+    };
+
+    SPDLOG_INFO("[Benchmark] Rendering {} warmup and {} measured frames", warmupFrames, frameCount);
+
+    timer frameTimer;
+    for (uint32_t frame = 0; renderer->getSubmittedFrameCount() < firstMeasuredFrame + frameCount; ++frame)
+    {
+        ZoneScoped;
+
+        if (window)
+        {
+            glfwPollEvents();
+            if (glfwWindowShouldClose(*window))
+                break;
+        }
+
+        frameTimer.resetTimer();
+
+        level->updateBenchCamera(frame * dt);
+        level->update(dt);
+
+        renderer->markTransformMatricesDirty(level->getDirtyTransformRanges());
+        renderer->setTransformIntegrationStep(dt);
+        renderer->updateUniformBufferEx(level->ubo);
+        float updateTime = frameTimer.getTimeAsSeconds();
+
+        uint64_t frameNumber = renderer->getSubmittedFrameCount();
+        renderer->update();
+        float frameTime = frameTimer.getTimeAsSeconds();
+
+        if (renderer->viewAspectChanged())
+            level->mainCamera.setAspect(renderer->getViewAspect());
+
+        // CPU phases of a skipped frame are those of the last submitted one
+        if (renderer->getSubmittedFrameCount() != frameNumber && frameNumber >= firstMeasuredFrame)
+        {
+            const vulkan::FrameCpuTimes &cpuTimes = renderer->getFrameCpuTimes();
+            frames.push_back({
+                .update = updateTime * 1000.0f,
+                .wait = cpuTimes.wait * 1000.0f,
+                .upload = cpuTimes.upload * 1000.0f,
+                .record = cpuTimes.record * 1000.0f,
+                .submit = cpuTimes.submit * 1000.0f,
+                .present = cpuTimes.present * 1000.0f,
+                .frame = frameTime * 1000.0f,
+            });
+        }
+
+        collectGpuTimes();
+    }
+
+    renderer->waitIdle();
+    collectGpuTimes();
+
+    auto getCameraPathName = [](ESettings::CameraPath cameraPath) {
+        switch (cameraPath)
+        {
+        case ESettings::CameraPath::Static:
+            return "static";
+        case ESettings::CameraPath::Orbit:
+            return "orbit";
+        case ESettings::CameraPath::Flythrough:
+            return "flythrough";
+        }
+        return "unknown";
+    };
+
+    const std::vector<benchmark::ReportParameter> parameters = {
+        {"entities", static_cast<double>(settings.BenchScene.entityCount)},
+        {"uniqueMeshes", static_cast<double>(settings.BenchScene.uniqueMeshCount)},
+        {"motionFraction", static_cast<double>(settings.BenchScene.motionFraction)},
+        {"cameraPath", std::string(getCameraPathName(settings.BenchScene.cameraPath))},
+        {"frames", static_cast<double>(frames.size())},
+        {"warmupFrames", static_cast<double>(warmupFrames)},
+        {"timestep", static_cast<double>(dt)},
+        {"headless", settings.Headless.enabled},
+        {"framesInFlight", static_cast<double>(settings.Renderer.framesInFlight)},
+        {"gpuDriven", settings.Renderer.gpuDriven},
+        {"gpuTransforms", settings.Renderer.gpuTransforms},
+        {"dynamicRendering", settings.Renderer.dynamicRendering},
+        {"parallelRecording", settings.Renderer.parallelRecording},
+    };
+
+    benchmark::writeFrameTimeReport(settings.BenchScene.outputPath, parameters, frames);
 }
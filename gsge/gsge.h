@@ -15,6 +15,10 @@
 #include "renderer/window.h"
 #include "renderer/settings.h"
 #include "core/stats.h"
+#include "core/jobSystem.h"
+#include "core/benchmark.h"
+#include "core/frameRecorder.h"
+#include "timer.h"
 #include "controller/mouse.h"
 #include <enums.h>
 
@@ -28,8 +32,10 @@ class gsge
 
   private:
     stats frameStats;
+    std::unique_ptr<FrameRecorder> frameRecorder; // Interactive app only
     GSGE_SETTINGS_INSTANCE_DECL;
 
+    std::shared_ptr<JobSystem> jobSystem;
     std::shared_ptr<Window> window;
     std::unique_ptr<Mouse> mouse;
     std::unique_ptr<vulkan> renderer;
@@ -38,6 +44,9 @@ class gsge
     EEngine::State engineState{EEngine::State::Running};
 
     void uploadBuffersToGPU();
+    void runHeadless();
+    void runBenchmark();
+    void reportFrameStats();
 
     void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 };
@@ -1,10 +1,12 @@
 #include "commandPool.h"
 
-CommandPool::CommandPool(std::shared_ptr<Device> &device, uint32_t queueIndex, const char *name) : device(device)
+CommandPool::CommandPool(std::shared_ptr<Device> &device, uint32_t queueIndex, const char *name,
+                         VkCommandPoolCreateFlags flags)
+    : device(device), name(name)
 {
     VkCommandPoolCreateInfo poolInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .flags = flags,
         .queueFamilyIndex = queueIndex,
     };
 
@@ -18,7 +20,43 @@ CommandPool::CommandPool(std::shared_ptr<Device> &device, uint32_t queueIndex, c
 
 CommandPool::~CommandPool()
 {
+    // Destroying the pool frees its command buffers
     vkDestroyCommandPool(*device, pool, nullptr);
 
     SPDLOG_TRACE("[Command pool] Destroyed");
 }
+
+/**
+ * \brief Hand out a free command buffer of the given level, allocating a new one when the free list is empty.
+ *
+ * The buffer is in the initial state after the pool was reset and stays owned by the pool until the next reset().
+ */
+VkCommandBuffer CommandPool::acquire(VkCommandBufferLevel level)
+{
+    std::vector<VkCommandBuffer> &levelBuffers = buffers[level];
+    size_t &used = usedBuffers[level];
+
+    if (used == levelBuffers.size())
+    {
+        VkCommandBufferAllocateInfo allocInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = pool,
+            .level = level,
+            .commandBufferCount = 1,
+        };
+
+        VkCommandBuffer commandBuffer;
+        GSGE_CHECK_RESULT(vkAllocateCommandBuffers(*device, &allocInfo, &commandBuffer));
+        levelBuffers.push_back(commandBuffer);
+
+        GSGE_DEBUGGER_SET_OBJECT_NAME(levelBuffers.back(), name.c_str());
+    }
+
+    return levelBuffers[used++];
+}
+
+void CommandPool::reset()
+{
+    GSGE_CHECK_RESULT(vkResetCommandPool(*device, pool, 0));
+    usedBuffers.fill(0);
+}
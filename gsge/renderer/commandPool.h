@@ -1,19 +1,33 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "device.h"
 #include "debugger.h"
 #include "core/tools.h"
 
+/**
+ * \brief Command pool handing out command buffers from a free list.
+ *
+ * Buffers are allocated on first demand and kept for the lifetime of the pool. reset() recycles the whole pool with a
+ * single vkResetCommandPool and returns every handed out buffer to the free list, which is cheaper on drivers than
+ * resetting buffers one by one. A pool must not be used by two threads at the same time.
+ */
 class CommandPool
 {
   public:
-    CommandPool(std::shared_ptr<Device> &device, uint32_t queueIndex, const char *name = "");
+    CommandPool(std::shared_ptr<Device> &device, uint32_t queueIndex, const char *name = "",
+                VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
     CommandPool(const CommandPool &) = delete;
     CommandPool &operator=(const CommandPool &) = delete;
     ~CommandPool();
 
+    VkCommandBuffer acquire(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY); //!< Next free buffer
+    void reset(); //!< Recycle all command buffers of the pool, none of them may be pending
+
     inline operator VkCommandPool()
     {
         return pool;
@@ -23,6 +37,11 @@ class CommandPool
     std::shared_ptr<Device> device;
     
     VkCommandPool pool = VK_NULL_HANDLE;
+    std::string name;
+
+    // Indexed by VkCommandBufferLevel, buffers from usedBuffers on are free
+    std::array<std::vector<VkCommandBuffer>, 2> buffers;
+    std::array<size_t, 2> usedBuffers{};
     
     GSGE_DEBUGGER_INSTANCE_DECL;
 };
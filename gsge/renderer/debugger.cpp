@@ -66,6 +66,8 @@ template void Debugger::setObjectName(VkSemaphore &object, const char *name);
 template void Debugger::setObjectName(VkImage &object, const char *name);
 template void Debugger::setObjectName(VkImageView &object, const char *name);
 template void Debugger::setObjectName(VkBuffer &object, const char *name);
+template void Debugger::setObjectName(VkQueryPool &object, const char *name);
+template void Debugger::setObjectName(VkPipelineCache &object, const char *name);
 
 template <typename T> void Debugger::setObjectName(T &object, const char *name)
 {
@@ -89,6 +91,10 @@ template <typename T> void Debugger::setObjectName(T &object, const char *name)
         objectNameInfo.objectType = VK_OBJECT_TYPE_IMAGE_VIEW;
     if (std::is_same<VkBuffer, T>::value)
         objectNameInfo.objectType = VK_OBJECT_TYPE_BUFFER;
+    if (std::is_same<VkQueryPool, T>::value)
+        objectNameInfo.objectType = VK_OBJECT_TYPE_QUERY_POOL;
+    if (std::is_same<VkPipelineCache, T>::value)
+        objectNameInfo.objectType = VK_OBJECT_TYPE_PIPELINE_CACHE;
 
     objectNameInfo.objectHandle = reinterpret_cast<uint64_t>(object);
     objectNameInfo.pObjectName = name;
@@ -1,19 +1,43 @@
 #include "device.h"
 
+#include <cstring>
+
+// The only translation unit compiling the VMA implementation
+#pragma warning(push)
+#pragma warning(disable : 4100 4127 4189 4324 26110 26495 26813)
+#define VMA_IMPLEMENTATION
+#include <vk_mem_alloc.h>
+#pragma warning(pop)
+
+/**
+ * \brief Create logical device, queues and allocator.
+ *
+ * Without a surface (headless rendering) VK_KHR_swapchain is not enabled and presentation is never queried, the
+ * present queue family is the graphics one.
+ */
 Device::Device(std::shared_ptr<Instance> &instance, std::shared_ptr<Surface> &surface) : instance(instance), surface(surface)
 {
+    if (surface)
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
     pickPhysicalDevice();
     selectPhysicalDevFeatures();
     findQueueFamilies();
     createLogicalDevice();
     createQueues();
-    querySurfaceCapabilities();
-    enumerateSurfaceFormats();
-    enumerateSurfacePresentModes();
+    createAllocator();
+
+    if (surface)
+    {
+        querySurfaceCapabilities();
+        enumerateSurfaceFormats();
+        enumerateSurfacePresentModes();
+    }
 }
 
 Device::~Device()
 {
+    vmaDestroyAllocator(allocator);
     vkDestroyDevice(device, nullptr);
 
     SPDLOG_TRACE("[Device] Destroyed");
@@ -24,6 +48,76 @@ VkPhysicalDevice Device::getPhysicalDeviceHandle() const
     return physicalDevice;
 }
 
+const VkPhysicalDeviceProperties &Device::getPhysicalDeviceProperties() const
+{
+    return physicalDeviceProperties;
+}
+
+const VkPhysicalDeviceVulkan12Features &Device::getEnabledVulkan12Features() const
+{
+    return physDevFeaturesSelected.v12;
+}
+
+const VkPhysicalDeviceVulkan13Features &Device::getEnabledVulkan13Features() const
+{
+    return physDevFeaturesSelected.v13;
+}
+
+const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT &Device::getEnabledGraphicsPipelineLibraryFeatures() const
+{
+    return graphicsPipelineLibraryFeatures;
+}
+
+const VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT &Device::getGraphicsPipelineLibraryProperties() const
+{
+    return graphicsPipelineLibraryProperties;
+}
+
+VmaAllocator Device::getAllocator() const
+{
+    return allocator;
+}
+
+/**
+ * \brief Log statistics of the allocator for every memory heap with allocated blocks.
+ *
+ * Fragmentation is the share of free block memory outside the largest free range, 0% means all free memory of
+ * the heap is one range, so it can satisfy any allocation that fits into it.
+ */
+void Device::logMemoryStats() const
+{
+    constexpr double MiB = 1024.0 * 1024.0;
+
+    VmaTotalStatistics stats;
+    vmaCalculateStatistics(allocator, &stats);
+
+    const VkPhysicalDeviceMemoryProperties *memoryProperties;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+
+    auto logStats = [&](const char *name, const VmaDetailedStatistics &heapStats) {
+        VkDeviceSize freeBytes = heapStats.statistics.blockBytes - heapStats.statistics.allocationBytes;
+        double fragmentation =
+            freeBytes > 0 ? 100.0 * (1.0 - static_cast<double>(heapStats.unusedRangeSizeMax) / freeBytes) : 0.0;
+
+        SPDLOG_INFO("[Device memory] {}: {} blocks {:.1f} MiB, {} allocations {:.1f} MiB, {} free ranges, fragmentation {:.1f}%",
+                    name, heapStats.statistics.blockCount, heapStats.statistics.blockBytes / MiB,
+                    heapStats.statistics.allocationCount, heapStats.statistics.allocationBytes / MiB,
+                    heapStats.unusedRangeCount, fragmentation);
+    };
+
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; ++heap)
+    {
+        if (stats.memoryHeap[heap].statistics.blockCount == 0)
+            continue;
+
+        bool deviceLocal = memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        std::string name = "Heap " + std::to_string(heap) + (deviceLocal ? " (device local)" : " (host)");
+        logStats(name.c_str(), stats.memoryHeap[heap]);
+    }
+
+    logStats("Total", stats.total);
+}
+
 uint32_t Device::getGraphicsQueueFamilyIdx() const
 {
     return graphicsQueueFamilyIdx;
@@ -44,6 +138,11 @@ uint32_t Device::getPresentQueueFamilyIdx() const
     return presentQueueFamilyIdx;
 }
 
+uint32_t Device::getTimestampValidBits(uint32_t familyIdx) const
+{
+    return queueFamilies[familyIdx].properties.queueFamilyProperties.timestampValidBits;
+}
+
 VkQueue Device::getGraphicsQueue() const
 {
     return graphicsQueue;
@@ -135,6 +234,7 @@ void Device::pickPhysicalDevice()
     if (candidates.rbegin()->first > 0)
     {
         physicalDevice = candidates.rbegin()->second;
+        vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
     }
     else
     {
@@ -191,12 +291,18 @@ uint64_t Device::rateDeviceSuitability(VkPhysicalDevice dev)
     // Maximum possible size of textures affects graphics quality
     score += deviceProperties2.properties.limits.maxImageDimension2D;
 
-    // Application can't function without geometry shaders
-    if (!physDevFeaturesAvailable.v10.features.geometryShader)
+    // Application requires Vulkan 1.3, geometry shaders are not used
+    if (deviceProperties2.properties.apiVersion < VK_API_VERSION_1_3)
     {
         return 0;
     }
 
+    // Software rasterizers (lavapipe, SwiftShader) only when there is no GPU, e.g. headless mode on CI machines
+    if (deviceProperties2.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+    {
+        score = 1;
+    }
+
     SPDLOG_TRACE("[Device] Selected: " + deviceInfoStr.str() + " score: " + std::to_string(score));
 
     vendorID = deviceProperties2.properties.vendorID;
@@ -218,7 +324,8 @@ void Device::findQueueFamilies()
     for (const auto &properties : queueFamilyProperties)
     {
         VkBool32 presentationSupport = VK_FALSE;
-        GSGE_CHECK_RESULT(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, *surface, &presentationSupport));
+        if (surface)
+            GSGE_CHECK_RESULT(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, *surface, &presentationSupport));
 
         queueFamilies.push_back(QueueFamily{.index = i, .properties = properties, .presentSupport = presentationSupport});
         i++;
@@ -284,6 +391,10 @@ void Device::findQueueFamilies()
         break;
     }
 
+    // Nothing is presented without a surface, present work stays on the graphics queue family
+    if (!surface)
+        presentQueueFamilyIdx = graphicsQueueFamilyIdx;
+
     addQueueToCreate(graphicsQueueFamilyIdx, graphicsQueuePriority, &graphicsQueue, "Graphics queue");
     addQueueToCreate(computeQueueFamilyIdx, computeQueuePriority, &computeQueue, "Compute queue");
     addQueueToCreate(transferQueueFamilyIdx, transferQueuePriority, &transferQueue, "Transfer queue");
@@ -349,11 +460,82 @@ void Device::createQueues()
     SPDLOG_TRACE("[Device queues] Created");
 }
 
+/**
+ * \brief Create the allocator all buffers and images are sub-allocated from.
+ *
+ * Resources are placed in shared blocks, VMA uses dedicated allocations only when the driver prefers or requires
+ * them (VK_KHR_dedicated_allocation is core in Vulkan 1.1) or the resource asks for one.
+ */
+void Device::createAllocator()
+{
+    VmaAllocatorCreateInfo allocatorInfo{
+        .physicalDevice = physicalDevice,
+        .device = device,
+        .instance = *instance,
+        .vulkanApiVersion = VK_API_VERSION_1_3,
+    };
+
+    GSGE_CHECK_RESULT(vmaCreateAllocator(&allocatorInfo, &allocator));
+    SPDLOG_TRACE("[Device] Allocator created");
+}
+
 void Device::selectPhysicalDevFeatures()
 {
     // TODO: Stupid idea. All available features are enabled. Be more selective.
     physDevFeaturesSelected = physDevFeaturesAvailable;
     physDevFeaturesSelected.v10.features.robustBufferAccess = VK_FALSE;
+
+    // Copied pNext pointers point into the available features, chain the selected ones instead
+    physDevFeaturesSelected.v10.pNext = &physDevFeaturesSelected.v11;
+    physDevFeaturesSelected.v11.pNext = &physDevFeaturesSelected.v12;
+    physDevFeaturesSelected.v12.pNext = &physDevFeaturesSelected.v13;
+    physDevFeaturesSelected.v13.pNext = nullptr;
+
+    selectGraphicsPipelineLibrary();
+}
+
+/**
+ * \brief Enable VK_EXT_graphics_pipeline_library when the selected device supports it.
+ *
+ * Graphics pipelines can then be linked from separately compiled vertex input, pre-rasterization, fragment shader
+ * and fragment output libraries. The features stay zeroed otherwise.
+ */
+void Device::selectGraphicsPipelineLibrary()
+{
+    uint32_t extensionCount = 0;
+    GSGE_CHECK_RESULT(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr));
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    GSGE_CHECK_RESULT(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data()));
+
+    auto isSupported = [&extensions](const char *name) {
+        return std::any_of(extensions.begin(), extensions.end(),
+                           [name](const VkExtensionProperties &extension) { return strcmp(extension.extensionName, name) == 0; });
+    };
+
+    if (!isSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) || !isSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+        return;
+
+    VkPhysicalDeviceFeatures2 features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &graphicsPipelineLibraryFeatures,
+    };
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    if (!graphicsPipelineLibraryFeatures.graphicsPipelineLibrary)
+        return;
+
+    VkPhysicalDeviceProperties2 properties{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &graphicsPipelineLibraryProperties,
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    deviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    deviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    physDevFeaturesSelected.v13.pNext = &graphicsPipelineLibraryFeatures;
+
+    SPDLOG_TRACE("[Device] Graphics pipeline library enabled, fast linking {}",
+                 graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking ? "supported" : "not supported");
 }
 
 VkSurfaceCapabilitiesKHR Device::getSurfaceCapabilities() const
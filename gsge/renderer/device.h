@@ -9,6 +9,11 @@
 
 #include <vulkan/vulkan.h>
 
+#pragma warning(push)
+#pragma warning(disable : 4100 4127 4189 4324 26110 26495 26813)
+#include <vk_mem_alloc.h>
+#pragma warning(pop)
+
 #pragma warning(suppress : 4275 6285 26498 26451 26800)
 #include <spdlog/spdlog.h>
 
@@ -39,12 +44,21 @@ class QueueFamily
 class Device
 {
   public:
-    Device(std::shared_ptr<Instance> &instance, std::shared_ptr<Surface> &surface);
+    Device(std::shared_ptr<Instance> &instance, std::shared_ptr<Surface> &surface); //!< Null surface for headless rendering
     Device(const Device &) = delete;
     Device &operator=(const Device &) = delete;
     ~Device();
 
     VkPhysicalDevice getPhysicalDeviceHandle() const;
+    const VkPhysicalDeviceProperties &getPhysicalDeviceProperties() const;
+    const VkPhysicalDeviceVulkan12Features &getEnabledVulkan12Features() const;
+    const VkPhysicalDeviceVulkan13Features &getEnabledVulkan13Features() const;
+    // graphicsPipelineLibrary is VK_FALSE unless VK_EXT_graphics_pipeline_library is enabled
+    const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT &getEnabledGraphicsPipelineLibraryFeatures() const;
+    const VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT &getGraphicsPipelineLibraryProperties() const;
+
+    VmaAllocator getAllocator() const; //!< Shared allocator of all buffer and image memory
+    void logMemoryStats() const;       //!< Log blocks, bytes and fragmentation of every memory heap in use
 
     void querySurfaceCapabilities();
     void enumerateSurfaceFormats();
@@ -55,6 +69,7 @@ class Device
     uint32_t getTransferQueueFamilyIdx() const;
     uint32_t getPresentQueueFamilyIdx() const;
     uint32_t getComputeQueueFamilyIdx() const;
+    uint32_t getTimestampValidBits(uint32_t familyIdx) const; //!< 0 - queues of the family do not support timestamps
 
     VkQueue getGraphicsQueue() const;
     VkQueue getTransferQueue() const;
@@ -72,6 +87,7 @@ class Device
 
   private:
     VkDevice device;
+    VmaAllocator allocator{VK_NULL_HANDLE};
     uint32_t vendorID; // Vendor ID of the selected physical device. Currently AMD, NVIDIA and Intel are supported
 
     GSGE_DEBUGGER_INSTANCE_DECL;
@@ -80,6 +96,7 @@ class Device
     std::shared_ptr<Surface> surface;
 
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties physicalDeviceProperties{}; // Properties and limits of the selected physical device
 
     std::vector<QueueFamily> queueFamilies;             // Vector of queue families and queues to create
     std::map<uint32_t, uint32_t> queueFamilyIdxCount; // Count of queues to create for each queue family
@@ -108,12 +125,20 @@ class Device
         VkPhysicalDeviceVulkan13Features v13{};
     } physDevFeaturesAvailable, physDevFeaturesSelected;
 
-    std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    // Chained after physDevFeaturesSelected.v13 when the extension is enabled
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProperties{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT};
+
+    std::vector<const char *> deviceExtensions; // VK_KHR_swapchain when there is a surface, optional extensions
 
     void pickPhysicalDevice();
     uint64_t rateDeviceSuitability(VkPhysicalDevice dev);
     void findQueueFamilies();
     void createLogicalDevice();
     void createQueues();
+    void createAllocator();
     void selectPhysicalDevFeatures();
+    void selectGraphicsPipelineLibrary();
 };
@@ -0,0 +1,241 @@
+#include "gpuProfiler.h"
+
+#include "commandPool.h"
+
+namespace
+{
+uint64_t getTimestampMask(uint32_t validBits)
+{
+    return validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+}
+} // namespace
+
+GpuProfiler::GpuProfiler(std::shared_ptr<Device> &device, uint32_t framesInFlight) : device(device)
+{
+    frames.resize(framesInFlight);
+
+#ifdef TRACY_ENABLE
+    {
+        // Tracy calibrates its context with a few submits, the buffer is not needed afterwards
+        CommandPool tracyCommandPool(device, device->getGraphicsQueueFamilyIdx(), "Tracy command pool");
+        tracyContext = TracyVkContext(device->getPhysicalDeviceHandle(), *device, device->getGraphicsQueue(),
+                                      tracyCommandPool.acquire());
+    }
+#endif
+
+    const VkPhysicalDeviceLimits &limits = device->getPhysicalDeviceProperties().limits;
+    uint32_t graphicsBits = device->getTimestampValidBits(device->getGraphicsQueueFamilyIdx());
+    uint32_t transferBits = device->getTimestampValidBits(device->getTransferQueueFamilyIdx());
+
+    if (!limits.timestampComputeAndGraphics || graphicsBits == 0)
+    {
+        SPDLOG_WARN("[GPU profiler] Timestamps are not supported, GPU time is not measured");
+        return;
+    }
+
+    if (!device->getEnabledVulkan12Features().hostQueryReset)
+    {
+        SPDLOG_WARN("[GPU profiler] hostQueryReset is not supported, GPU time is not measured");
+        return;
+    }
+
+    timestampPeriod = limits.timestampPeriod;
+    timestampMasks.fill(getTimestampMask(graphicsBits));
+    timestampMasks[static_cast<size_t>(GpuScope::TransformCopy)] = transferBits ? getTimestampMask(transferBits) : 0;
+
+    if (transferBits == 0)
+        SPDLOG_INFO("[GPU profiler] Transfer queue does not support timestamps, transform copy is not measured");
+
+    VkQueryPoolCreateInfo queryPoolInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = framesInFlight * scopeCount * 2,
+    };
+
+    GSGE_CHECK_RESULT(vkCreateQueryPool(*device, &queryPoolInfo, nullptr, &queryPool));
+    GSGE_DEBUGGER_SET_OBJECT_NAME(queryPool, "GPU profiler query pool");
+
+    // Queries have to be reset before their first use
+    vkResetQueryPool(*device, queryPool, 0, queryPoolInfo.queryCount);
+
+    SPDLOG_TRACE("[GPU profiler] Created");
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    vkDestroyQueryPool(*device, queryPool, nullptr);
+
+#ifdef TRACY_ENABLE
+    flushTracy();
+    TracyVkDestroy(tracyContext);
+#endif
+
+    SPDLOG_TRACE("[GPU profiler] Destroyed");
+}
+
+void GpuProfiler::beginFrame(uint32_t frame)
+{
+    retiredFrames.swap(carriedFrames);
+    carriedFrames.clear();
+    retire(frame);
+    currentFrame = frame;
+}
+
+void GpuProfiler::endFrame(uint64_t frameNumber)
+{
+    frames[currentFrame].frameNumber = frameNumber;
+}
+
+void GpuProfiler::retireAll()
+{
+    retiredFrames.swap(carriedFrames);
+    carriedFrames.clear();
+
+    // The frame after the current one was submitted first
+    uint32_t frameCount = static_cast<uint32_t>(frames.size());
+    for (uint32_t i = 1; i <= frameCount; ++i)
+        retire((currentFrame + i) % frameCount);
+}
+
+void GpuProfiler::carryRetiredFrames(const std::vector<GpuFrameTimes> &frames)
+{
+    carriedFrames.insert(carriedFrames.end(), frames.begin(), frames.end());
+}
+
+void GpuProfiler::begin(VkCommandBuffer commandBuffer, GpuScope scope)
+{
+    uint32_t bit = 1u << static_cast<uint32_t>(scope);
+    FrameQueries &queries = frames[currentFrame];
+
+    if (!timestampMasks[static_cast<size_t>(scope)] || (queries.begunScopes & bit))
+        return;
+
+    queries.begunScopes |= bit;
+    vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, queryPool, getQuery(currentFrame, scope));
+}
+
+void GpuProfiler::end(VkCommandBuffer commandBuffer, GpuScope scope)
+{
+    uint32_t bit = 1u << static_cast<uint32_t>(scope);
+    FrameQueries &queries = frames[currentFrame];
+
+    if (!(queries.begunScopes & bit) || (queries.endedScopes & bit))
+        return;
+
+    queries.endedScopes |= bit;
+    vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, queryPool,
+                         getQuery(currentFrame, scope) + 1);
+}
+
+void GpuProfiler::collect(VkCommandBuffer commandBuffer)
+{
+#ifdef TRACY_ENABLE
+    TracyVkCollect(tracyContext, commandBuffer);
+#endif
+}
+
+bool GpuProfiler::isEnabled() const
+{
+    return queryPool != VK_NULL_HANDLE;
+}
+
+TracyVkCtx GpuProfiler::getTracyContext() const
+{
+    return tracyContext;
+}
+
+const std::vector<GpuFrameTimes> &GpuProfiler::getRetiredFrames() const
+{
+    return retiredFrames;
+}
+
+/**
+ * \brief Read the timestamps of a frame in flight and reset its queries for the next use.
+ *
+ * Scopes begun but not ended, e.g. by a frame abandoned on resize, are reset without being reported.
+ */
+void GpuProfiler::retire(uint32_t frame)
+{
+    FrameQueries &queries = frames[frame];
+    if (queries.begunScopes == 0)
+    {
+        queries = {};
+        return;
+    }
+
+    if (queries.frameNumber != noFrame)
+    {
+        GpuFrameTimes frameTimes{.frameNumber = queries.frameNumber};
+        frameTimes.scopes.fill(-1.0f);
+
+        for (uint32_t scope = 0; scope < scopeCount; ++scope)
+        {
+            if (!(queries.endedScopes & (1u << scope)))
+                continue;
+
+            std::array<uint64_t, 2> timestamps{};
+            VkResult result = vkGetQueryPoolResults(*device, queryPool, getQuery(frame, static_cast<GpuScope>(scope)), 2,
+                                                    sizeof(timestamps), timestamps.data(), sizeof(timestamps[0]),
+                                                    VK_QUERY_RESULT_64_BIT);
+            if (result != VK_SUCCESS)
+                continue;
+
+            uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMasks[scope];
+            frameTimes.scopes[scope] = static_cast<float>(ticks) * timestampPeriod * 1e-9f;
+        }
+
+        retiredFrames.push_back(frameTimes);
+    }
+
+    vkResetQueryPool(*device, queryPool, getQuery(frame, GpuScope::Frame), scopeCount * 2);
+    queries = {};
+}
+
+/**
+ * \brief Record and submit a command buffer that only collects Tracy zones, so zones of the last frames reach Tracy
+ * before its context is destroyed.
+ */
+void GpuProfiler::flushTracy()
+{
+    if (!tracyContext)
+        return;
+
+    CommandPool tracyCommandPool(device, device->getGraphicsQueueFamilyIdx(), "Tracy command pool");
+    VkCommandBuffer commandBuffer = tracyCommandPool.acquire();
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    GSGE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+    collect(commandBuffer);
+    GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+    VkCommandBufferSubmitInfo commandBufferInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = commandBuffer,
+    };
+    VkSubmitInfo2 submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &commandBufferInfo,
+    };
+    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+    GSGE_CHECK_RESULT(vkQueueWaitIdle(device->getGraphicsQueue()));
+}
+
+uint32_t GpuProfiler::getQuery(uint32_t frame, GpuScope scope) const
+{
+    return (frame * scopeCount + static_cast<uint32_t>(scope)) * 2;
+}
+
+GpuProfiler::Zone::Zone(GpuProfiler &profiler, VkCommandBuffer commandBuffer, GpuScope scope)
+    : profiler(profiler), commandBuffer(commandBuffer), scope(scope)
+{
+    profiler.begin(commandBuffer, scope);
+}
+
+GpuProfiler::Zone::~Zone()
+{
+    profiler.end(commandBuffer, scope);
+}
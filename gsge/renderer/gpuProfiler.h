@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <tracy/TracyVulkan.hpp>
+
+#include "device.h"
+#include "debugger.h"
+#include "types.h"
+#include "core/tools.h"
+
+// Measures the rest of the enclosing C++ scope as a GpuScope of the profiler and as a Tracy GPU zone. Graphics queue
+// only, the Tracy context belongs to it. name must be a string literal
+#define GSGE_GPU_ZONE(profiler, commandBuffer, scope, name)                                                            \
+    GpuProfiler::Zone gpuProfilerZone(profiler, commandBuffer, scope);                                                \
+    TracyVkNamedZone((profiler).getTracyContext(), tracyGpuZone, commandBuffer, name,                                \
+                     (profiler).getTracyContext() != nullptr)
+
+/**
+ * \brief GPU time of the passes of every frame from timestamp queries, read back without stalling.
+ *
+ * Every frame in flight owns a begin and an end query for each GpuScope. Results are read when the frame's slot is
+ * reused by beginFrame(), its GPU work has finished by then, so they are available at once. Queries are reset on the
+ * host right after the readback, which keeps vkCmdResetQueryPool out of the command buffers and makes the same pool
+ * usable from the graphics and the transfer queue. Only the first begin/end pair of a scope in a frame is measured.
+ *
+ * The profiler is disabled without timestamp support on the graphics queue or without hostQueryReset.
+ */
+class GpuProfiler
+{
+  public:
+    GpuProfiler(std::shared_ptr<Device> &device, uint32_t framesInFlight);
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+    ~GpuProfiler();
+
+    void beginFrame(uint32_t frame);     //!< Retire the previous use of the frame's queries, its GPU work must be finished
+    void endFrame(uint64_t frameNumber); //!< Command buffers of the current frame are submitted
+    void retireAll();                    //!< Retire submitted frames oldest first, device must be idle
+    //! Report frames retired by another profiler, e.g. the one replaced on a frames in flight change, with the next
+    //! beginFrame() or retireAll()
+    void carryRetiredFrames(const std::vector<GpuFrameTimes> &frames);
+
+    void begin(VkCommandBuffer commandBuffer, GpuScope scope);
+    void end(VkCommandBuffer commandBuffer, GpuScope scope);
+    void collect(VkCommandBuffer commandBuffer); //!< Collect Tracy GPU zones, graphics queue outside of a render pass
+
+    bool isEnabled() const;
+    TracyVkCtx getTracyContext() const; //!< Null without TRACY_ENABLE
+    const std::vector<GpuFrameTimes> &getRetiredFrames() const; //!< Frames retired by the last beginFrame() or retireAll()
+
+    /**
+     * \brief Begins a scope on construction and ends it on destruction.
+     */
+    class Zone
+    {
+      public:
+        Zone(GpuProfiler &profiler, VkCommandBuffer commandBuffer, GpuScope scope);
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+        ~Zone();
+
+      private:
+        GpuProfiler &profiler;
+        VkCommandBuffer commandBuffer;
+        GpuScope scope;
+    };
+
+  private:
+    static constexpr uint32_t scopeCount = static_cast<uint32_t>(GpuScope::Count);
+    static constexpr uint64_t noFrame = UINT64_MAX;
+
+    struct FrameQueries
+    {
+        uint64_t frameNumber{noFrame}; // Submitted frame the queries belong to
+        uint32_t begunScopes{0};       // Bit per GpuScope with a begin timestamp written
+        uint32_t endedScopes{0};       // Bit per GpuScope with an end timestamp written
+    };
+
+    std::shared_ptr<Device> device;
+
+    VkQueryPool queryPool{VK_NULL_HANDLE}; // Begin and end query per scope per frame in flight
+    float timestampPeriod{1.0f};           // Nanoseconds per timestamp tick
+    std::array<uint64_t, scopeCount> timestampMasks{}; // Valid bits of the scope's queue, 0 - scope is not measured
+
+    uint32_t currentFrame{0};
+    std::vector<FrameQueries> frames;
+    std::vector<GpuFrameTimes> retiredFrames;
+    std::vector<GpuFrameTimes> carriedFrames; // Reported before the frames retired next
+
+    TracyVkCtx tracyContext{nullptr};
+
+    GSGE_DEBUGGER_INSTANCE_DECL;
+
+    void retire(uint32_t frame);
+    void flushTracy(); //!< Collect Tracy zones of all submitted frames, device must be idle
+    uint32_t getQuery(uint32_t frame, GpuScope scope) const; //!< Begin query of the scope, end query follows it
+};
@@ -71,6 +71,10 @@ void Instance::prepareExtensionList()
     instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 #endif // !NDEBUG
 
+    // Headless rendering has no window surface, GLFW is not even initialized
+    if (settings.Headless.enabled)
+        return;
+
     // get required extensions for glfw, basically VK_KHR_SURFACE and win32_something
     uint32_t glfwExtensionCount = 0;
     const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
@@ -0,0 +1,124 @@
+#include "pipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+static constexpr const char *cacheDirectory = "cache";
+
+PipelineCache::PipelineCache(std::shared_ptr<Device> &device) : device(device)
+{
+    const VkPhysicalDeviceProperties &properties = device->getPhysicalDeviceProperties();
+
+    std::string uuid;
+    for (uint8_t byte : properties.pipelineCacheUUID)
+        uuid += std::format("{:02x}", byte);
+
+    std::string fileName = std::format("pipelines_{:04x}_{:04x}_{:08x}_{}.bin", properties.vendorID, properties.deviceID,
+                                       properties.driverVersion, uuid);
+    path = (std::filesystem::path(cacheDirectory) / fileName).string();
+
+    std::vector<char> data = load();
+    warm = !data.empty();
+
+    VkPipelineCacheCreateInfo cacheInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data(),
+    };
+
+    GSGE_CHECK_RESULT(vkCreatePipelineCache(*device, &cacheInfo, nullptr, &cache));
+
+    GSGE_DEBUGGER_SET_OBJECT_NAME(cache, "Pipeline cache");
+    SPDLOG_TRACE("[Pipeline cache] Created, {} bytes loaded from {}", data.size(), path);
+}
+
+PipelineCache::~PipelineCache()
+{
+    save();
+    vkDestroyPipelineCache(*device, cache, nullptr);
+
+    SPDLOG_TRACE("[Pipeline cache] Destroyed");
+}
+
+bool PipelineCache::isWarm() const
+{
+    return warm;
+}
+
+/**
+ * \brief Write the cache data to disk, a failure only costs compilation on the next run.
+ */
+void PipelineCache::save()
+{
+    size_t size = 0;
+    GSGE_CHECK_RESULT(vkGetPipelineCacheData(*device, cache, &size, nullptr));
+
+    std::vector<char> data(size);
+    GSGE_CHECK_RESULT(vkGetPipelineCacheData(*device, cache, &size, data.data()));
+    data.resize(size);
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    // Written next to the target and renamed, so an interrupted write never leaves a partial file behind
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(data.data(), data.size()))
+        {
+            SPDLOG_WARN("[Pipeline cache] Failed to write {}", tempPath);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        SPDLOG_WARN("[Pipeline cache] Failed to rename {}: {}", tempPath, error.message());
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    SPDLOG_TRACE("[Pipeline cache] Saved {} bytes to {}", data.size(), path);
+}
+
+/**
+ * \brief Read cache data from disk, empty when the file is missing or was written for another device or driver.
+ */
+std::vector<char> PipelineCache::load()
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        SPDLOG_INFO("[Pipeline cache] No cache file {}, pipelines are compiled cold", path);
+        return {};
+    }
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(data.data(), data.size()) || !isValid(data))
+    {
+        SPDLOG_WARN("[Pipeline cache] Ignoring invalid cache file {}", path);
+        return {};
+    }
+
+    return data;
+}
+
+bool PipelineCache::isValid(const std::vector<char> &data) const
+{
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+        return false;
+
+    VkPipelineCacheHeaderVersionOne header;
+    memcpy(&header, data.data(), sizeof(header));
+
+    const VkPhysicalDeviceProperties &properties = device->getPhysicalDeviceProperties();
+
+    return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) && header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
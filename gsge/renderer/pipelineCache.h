@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "debugger.h"
+#include "core/tools.h"
+
+/**
+ * \brief VkPipelineCache persisted to disk between runs.
+ *
+ * The file name is keyed by vendor, device, driver version and pipeline cache UUID of the physical device, so every
+ * driver gets its own file. The header of loaded data is validated against the device as well, drivers reject
+ * foreign data only with varying success. Data is saved on destruction and by save().
+ */
+class PipelineCache
+{
+  public:
+    PipelineCache(std::shared_ptr<Device> &device);
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+    ~PipelineCache();
+
+    void save();
+    bool isWarm() const; //!< Cache was created from valid data on disk
+
+    inline operator VkPipelineCache()
+    {
+        return cache;
+    }
+
+  private:
+    std::shared_ptr<Device> device;
+
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    std::string path;
+    bool warm{false};
+
+    GSGE_DEBUGGER_INSTANCE_DECL;
+
+    std::vector<char> load();
+    bool isValid(const std::vector<char> &data) const;
+};
@@ -0,0 +1,575 @@
+#include "pipelineManager.h"
+
+#include <format>
+
+#include "renderTargets.h"
+#include "timer.h"
+
+const char *getName(ShaderSet shaderSet)
+{
+    switch (shaderSet)
+    {
+    case ShaderSet::PerFragmentLight:
+        return "per fragment lighting";
+    case ShaderSet::PerVertexLight:
+        return "per vertex lighting";
+    default:
+        return "unknown";
+    }
+}
+
+bool GraphicsPipelineKey::isCompatible(const GraphicsPipelineKey &other) const
+{
+    return sampleCount == other.sampleCount && colorFormat == other.colorFormat && dynamicRendering == other.dynamicRendering;
+}
+
+std::string GraphicsPipelineKey::toString() const
+{
+    return std::format("Graphics pipeline ({}, {} samples, {})", getName(shaderSet), static_cast<uint32_t>(sampleCount),
+                       dynamicRendering ? "dynamic rendering" : "render pass");
+}
+
+size_t GraphicsPipelineKeyHash::operator()(const GraphicsPipelineKey &key) const
+{
+    size_t hash = 0;
+    auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2); };
+
+    combine(static_cast<size_t>(key.shaderSet));
+    combine(static_cast<size_t>(key.vertexLayout));
+    combine(static_cast<size_t>(key.sampleCount));
+    combine(static_cast<size_t>(key.cullMode));
+    combine(static_cast<size_t>(key.polygonMode));
+    combine(static_cast<size_t>(key.colorFormat));
+    combine(static_cast<size_t>(key.dynamicRendering));
+
+    return hash;
+}
+
+/**
+ * \brief Create infos of every state of a permutation, libraries pick the states of their part.
+ *
+ * Viewport and scissor are dynamic, so nothing depends on the swapchain extent.
+ */
+struct PipelineManager::PipelineState
+{
+    std::array<VkPipelineShaderStageCreateInfo, 2> stages;
+    VkPipelineVertexInputStateCreateInfo vertexInput;
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+    VkPipelineViewportStateCreateInfo viewport;
+    VkPipelineRasterizationStateCreateInfo rasterization;
+    VkPipelineMultisampleStateCreateInfo multisample;
+    VkPipelineDepthStencilStateCreateInfo depthStencil;
+    VkPipelineColorBlendAttachmentState colorBlendAttachment;
+    VkPipelineColorBlendStateCreateInfo colorBlend;
+    std::array<VkDynamicState, 2> dynamicStates;
+    VkPipelineDynamicStateCreateInfo dynamic;
+    VkFormat colorFormat;
+    VkPipelineRenderingCreateInfo rendering; // Chained by keys with dynamic rendering
+
+    PipelineState(const PipelineManager &manager, const GraphicsPipelineKey &key);
+    PipelineState(const PipelineState &) = delete;
+    PipelineState &operator=(const PipelineState &) = delete;
+};
+
+PipelineManager::PipelineState::PipelineState(const PipelineManager &manager, const GraphicsPipelineKey &key)
+{
+    const ShaderModules &modules = manager.shaderModules[static_cast<size_t>(key.shaderSet)];
+    const VertexInput &input = manager.vertexInputs[static_cast<size_t>(key.vertexLayout)];
+
+    stages = {{
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = modules.vertex,
+            .pName = "main",
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = modules.fragment,
+            .pName = "main",
+        },
+    }};
+
+    vertexInput = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(input.bindings.size()),
+        .pVertexBindingDescriptions = input.bindings.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(input.attributes.size()),
+        .pVertexAttributeDescriptions = input.attributes.data(),
+    };
+
+    inputAssembly = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .primitiveRestartEnable = VK_FALSE,
+    };
+
+    viewport = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1,
+    };
+
+    rasterization = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .rasterizerDiscardEnable = VK_FALSE,
+        .polygonMode = key.polygonMode,
+        .cullMode = key.cullMode,
+        .frontFace = VK_FRONT_FACE_CLOCKWISE,
+        .depthBiasEnable = VK_FALSE,
+        .lineWidth = 1.0f,
+    };
+
+    multisample = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = key.sampleCount,
+        .sampleShadingEnable = VK_FALSE,
+        .minSampleShading = 1.0f,
+    };
+
+    depthStencil = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 1.0f,
+    };
+
+    colorBlendAttachment = {
+        .blendEnable = VK_FALSE,
+        .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+    };
+
+    colorBlend = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_COPY,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment,
+        .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f},
+    };
+
+    dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    dynamic = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data(),
+    };
+
+    // Dynamic rendering pipelines declare attachment formats instead of a render pass
+    colorFormat = key.colorFormat;
+    rendering = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat = RenderTargets::depthFormat,
+    };
+}
+
+static VkRenderPass getRenderPassHandle(const GraphicsPipelineKey &key, const std::shared_ptr<RenderPass> &renderPass)
+{
+    if (key.dynamicRendering)
+        return VK_NULL_HANDLE;
+
+    if (!renderPass)
+        throw std::runtime_error("[Pipeline manager] No render pass set for a pipeline without dynamic rendering!");
+
+    return *renderPass;
+}
+
+PipelineManager::PipelineManager(std::shared_ptr<Device> &device, std::shared_ptr<JobSystem> &jobSystem,
+                                 PipelineCache &pipelineCache, VkPipelineLayout pipelineLayout)
+    : device(device), jobSystem(jobSystem), pipelineCache(pipelineCache), pipelineLayout(pipelineLayout)
+{
+    useLibraries = device->getEnabledGraphicsPipelineLibraryFeatures().graphicsPipelineLibrary == VK_TRUE;
+
+    SPDLOG_TRACE("[Pipeline manager] Created, {}", useLibraries ? "graphics pipeline libraries" : "monolithic pipelines");
+}
+
+PipelineManager::~PipelineManager()
+{
+    // Jobs may queue further jobs, wait until none is left
+    for (size_t i = 0;; ++i)
+    {
+        std::shared_future<void> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (i == jobs.size())
+                break;
+            job = jobs[i];
+        }
+        jobSystem->wait(job);
+    }
+
+    for (VkPipeline pipeline : createdPipelines)
+        vkDestroyPipeline(*device, pipeline, nullptr);
+
+    for (const ShaderModules &modules : shaderModules)
+    {
+        vkDestroyShaderModule(*device, modules.vertex, nullptr);
+        vkDestroyShaderModule(*device, modules.fragment, nullptr);
+    }
+
+    SPDLOG_TRACE("[Pipeline manager] Destroyed, {} pipelines and libraries", createdPipelines.size());
+}
+
+/**
+ * \brief Register shader modules of a shader set, has to be called before the first get() of its keys.
+ */
+void PipelineManager::setShaderSet(ShaderSet shaderSet, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
+    shaderModules[static_cast<size_t>(shaderSet)] = {.vertex = vertexShader, .fragment = fragmentShader};
+}
+
+/**
+ * \brief Register bindings and attributes of a vertex layout, has to be called before the first get() of its keys.
+ */
+void PipelineManager::setVertexLayout(VertexLayout vertexLayout, const std::vector<VkVertexInputBindingDescription> &bindings,
+                                      const std::vector<VkVertexInputAttributeDescription> &attributes)
+{
+    vertexInputs[static_cast<size_t>(vertexLayout)] = {.bindings = bindings, .attributes = attributes};
+}
+
+/**
+ * \brief Set render pass new permutations are created against, jobs already queued keep the previous one.
+ *
+ * Render passes are compatible as long as their attachment formats and sample counts match, which are part of the key.
+ */
+void PipelineManager::setRenderPass(std::shared_ptr<RenderPass> renderPass)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->renderPass = renderPass;
+}
+
+bool PipelineManager::isUsingLibraries() const
+{
+    return useLibraries;
+}
+
+/**
+ * \brief Return the pipeline of the key, or queue its build on the job system and return VK_NULL_HANDLE.
+ *
+ * Callers keep drawing with a pipeline they already have until the requested one is ready. A job system without
+ * workers never runs background jobs on its own, so the pipeline is built right away in that case.
+ */
+VkPipeline PipelineManager::get(const GraphicsPipelineKey &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto [entry, inserted] = pipelines.try_emplace(key);
+        if (!inserted)
+            return entry->second.handle;
+
+        auto ready = std::make_shared<std::promise<void>>();
+        entry->second.ready = ready->get_future().share();
+
+        std::shared_ptr<RenderPass> keyRenderPass = key.dynamicRendering ? nullptr : renderPass;
+        jobs.push_back(jobSystem->submitBackground([this, key, keyRenderPass, ready]() {
+            build(key, keyRenderPass, *ready);
+        }).share());
+    }
+
+    if (jobSystem->getThreadCount() > 1)
+        return VK_NULL_HANDLE;
+
+    return getBlocking(key);
+}
+
+/**
+ * \brief Return the pipeline of the key, building it first if needed. Rethrows errors of the build.
+ */
+VkPipeline PipelineManager::getBlocking(const GraphicsPipelineKey &key)
+{
+    VkPipeline pipeline = get(key);
+    if (pipeline != VK_NULL_HANDLE)
+        return pipeline;
+
+    std::shared_future<void> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready = pipelines[key].ready;
+    }
+
+    jobSystem->wait(ready);
+    ready.get();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return pipelines[key].handle;
+}
+
+/**
+ * \brief Build job of a permutation, signals ready once a usable pipeline is stored.
+ *
+ * Libraries of the key are created or taken from the cache and fast linked, link time optimization is queued
+ * as another background job so the fast linked pipeline is usable as soon as possible.
+ */
+void PipelineManager::build(const GraphicsPipelineKey &key, std::shared_ptr<RenderPass> renderPass, std::promise<void> &ready)
+{
+    try
+    {
+        timer buildTimer;
+
+        if (!useLibraries)
+        {
+            store(key, createPipeline(key, renderPass), "compiled", buildTimer.getTimeAsSeconds());
+            ready.set_value();
+            return;
+        }
+
+        std::array<VkPipeline, LibraryPartCount> parts;
+        for (uint32_t part = 0; part < LibraryPartCount; ++part)
+            parts[part] = getLibrary(static_cast<LibraryPart>(part), key, renderPass);
+
+        store(key, linkLibraries(parts, false), "linked", buildTimer.getTimeAsSeconds());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(jobSystem->submitBackground([this, key, parts]() { optimize(key, parts); }).share());
+        }
+
+        ready.set_value();
+    }
+    catch (...)
+    {
+        ready.set_exception(std::current_exception());
+    }
+}
+
+void PipelineManager::optimize(const GraphicsPipelineKey &key, const std::array<VkPipeline, LibraryPartCount> &parts)
+{
+    timer optimizeTimer;
+    store(key, linkLibraries(parts, true), "optimized", optimizeTimer.getTimeAsSeconds());
+}
+
+/**
+ * \brief Make the pipeline the one returned for the key, the replaced one is kept until the manager is destroyed.
+ */
+void PipelineManager::store(const GraphicsPipelineKey &key, VkPipeline pipeline, const char *stage, float seconds)
+{
+    std::string name = key.toString();
+    GSGE_DEBUGGER_SET_OBJECT_NAME(pipeline, name.c_str());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pipelines[key].handle = pipeline;
+        createdPipelines.push_back(pipeline);
+    }
+
+    SPDLOG_INFO("[Pipeline manager] {} {} in {:.2f} ms, {} pipeline cache", name, stage, seconds * 1000.0f,
+                pipelineCache.isWarm() ? "warm" : "cold");
+}
+
+VkPipeline PipelineManager::createPipeline(const GraphicsPipelineKey &key, const std::shared_ptr<RenderPass> &renderPass)
+{
+    PipelineState state(*this, key);
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = key.dynamicRendering ? &state.rendering : nullptr,
+        .stageCount = static_cast<uint32_t>(state.stages.size()),
+        .pStages = state.stages.data(),
+        .pVertexInputState = &state.vertexInput,
+        .pInputAssemblyState = &state.inputAssembly,
+        .pViewportState = &state.viewport,
+        .pRasterizationState = &state.rasterization,
+        .pMultisampleState = &state.multisample,
+        .pDepthStencilState = &state.depthStencil,
+        .pColorBlendState = &state.colorBlend,
+        .pDynamicState = &state.dynamic,
+        .layout = pipelineLayout,
+        .renderPass = getRenderPassHandle(key, renderPass),
+        .subpass = 0,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkPipeline pipeline;
+    GSGE_CHECK_RESULT(vkCreateGraphicsPipelines(*device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline));
+
+    return pipeline;
+}
+
+/**
+ * \brief Return the library of the part, created by the calling job if no other job has started it yet.
+ */
+VkPipeline PipelineManager::getLibrary(LibraryPart part, const GraphicsPipelineKey &key,
+                                       const std::shared_ptr<RenderPass> &renderPass)
+{
+    GraphicsPipelineKey libraryKey = getLibraryKey(part, key);
+
+    std::promise<VkPipeline> created;
+    std::shared_future<VkPipeline> library;
+    bool inserted = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto entry = libraries[part].find(libraryKey);
+        inserted = entry == libraries[part].end();
+        if (inserted)
+            entry = libraries[part].emplace(libraryKey, created.get_future().share()).first;
+
+        library = entry->second;
+    }
+
+    // The creating job is running already, so waiting on it can't deadlock
+    if (!inserted)
+        return library.get();
+
+    try
+    {
+        VkPipeline handle = createLibrary(part, libraryKey, renderPass);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            createdPipelines.push_back(handle);
+        }
+
+        created.set_value(handle);
+        return handle;
+    }
+    catch (...)
+    {
+        created.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+VkPipeline PipelineManager::createLibrary(LibraryPart part, const GraphicsPipelineKey &key,
+                                          const std::shared_ptr<RenderPass> &renderPass)
+{
+    PipelineState state(*this, key);
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+    };
+
+    // Libraries keep their intermediate representation, so the optimized link can still optimize across parts
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    switch (part)
+    {
+    case VertexInputLibrary:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+        pipelineInfo.pVertexInputState = &state.vertexInput;
+        pipelineInfo.pInputAssemblyState = &state.inputAssembly;
+        break;
+    case PreRasterizationLibrary:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+        pipelineInfo.stageCount = 1;
+        pipelineInfo.pStages = &state.stages[0];
+        pipelineInfo.pViewportState = &state.viewport;
+        pipelineInfo.pRasterizationState = &state.rasterization;
+        pipelineInfo.pDynamicState = &state.dynamic;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.renderPass = getRenderPassHandle(key, renderPass);
+        break;
+    case FragmentShaderLibrary:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+        pipelineInfo.stageCount = 1;
+        pipelineInfo.pStages = &state.stages[1];
+        pipelineInfo.pMultisampleState = &state.multisample;
+        pipelineInfo.pDepthStencilState = &state.depthStencil;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.renderPass = getRenderPassHandle(key, renderPass);
+        break;
+    case FragmentOutputLibrary:
+        libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+        pipelineInfo.pMultisampleState = &state.multisample;
+        pipelineInfo.pColorBlendState = &state.colorBlend;
+        pipelineInfo.renderPass = getRenderPassHandle(key, renderPass);
+        break;
+    default:
+        throw std::runtime_error("[Pipeline manager] Invalid library part!");
+    }
+
+    if (key.dynamicRendering && part != VertexInputLibrary)
+        libraryInfo.pNext = &state.rendering;
+
+    VkPipeline library;
+    GSGE_CHECK_RESULT(vkCreateGraphicsPipelines(*device, pipelineCache, 1, &pipelineInfo, nullptr, &library));
+
+    return library;
+}
+
+/**
+ * \brief Link a complete pipeline from the libraries, link time optimization makes it as fast as a monolithic one.
+ */
+VkPipeline PipelineManager::linkLibraries(const std::array<VkPipeline, LibraryPartCount> &parts, bool optimized)
+{
+    VkPipelineLibraryCreateInfoKHR libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .libraryCount = static_cast<uint32_t>(parts.size()),
+        .pLibraries = parts.data(),
+    };
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = optimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : VkPipelineCreateFlags{0},
+        .layout = pipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkPipeline pipeline;
+    GSGE_CHECK_RESULT(vkCreateGraphicsPipelines(*device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline));
+
+    return pipeline;
+}
+
+/**
+ * \brief Key of the library of a part, fields the part does not depend on are reset so permutations share it.
+ *
+ * Without dynamic rendering every part but vertex input is created against a render pass, which has to be
+ * compatible with the one of the linked pipeline, so attachment format and sample count stay in their keys.
+ */
+GraphicsPipelineKey PipelineManager::getLibraryKey(LibraryPart part, const GraphicsPipelineKey &key)
+{
+    if (part == VertexInputLibrary)
+        return {.vertexLayout = key.vertexLayout};
+
+    GraphicsPipelineKey libraryKey{.dynamicRendering = key.dynamicRendering};
+
+    switch (part)
+    {
+    case PreRasterizationLibrary:
+        libraryKey.shaderSet = key.shaderSet;
+        libraryKey.cullMode = key.cullMode;
+        libraryKey.polygonMode = key.polygonMode;
+        break;
+    case FragmentShaderLibrary:
+        libraryKey.shaderSet = key.shaderSet;
+        libraryKey.sampleCount = key.sampleCount;
+        break;
+    default:
+        libraryKey.sampleCount = key.sampleCount;
+        libraryKey.colorFormat = key.colorFormat;
+        break;
+    }
+
+    if (!key.dynamicRendering)
+    {
+        libraryKey.sampleCount = key.sampleCount;
+        libraryKey.colorFormat = key.colorFormat;
+    }
+
+    return libraryKey;
+}
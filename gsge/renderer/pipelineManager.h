@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "renderPass.h"
+#include "pipelineCache.h"
+#include "debugger.h"
+#include "core/tools.h"
+#include "core/jobSystem.h"
+
+enum class ShaderSet : uint32_t
+{
+    PerFragmentLight, // shaders/per_fragment_light_shader.*
+    PerVertexLight,   // shaders/per_vertex_light_shader.*
+    Count
+};
+
+enum class VertexLayout : uint32_t
+{
+    PositionNormal, // Positions in binding 0, normals in binding 1
+    Count
+};
+
+const char *getName(ShaderSet shaderSet);
+
+/**
+ * \brief Everything a graphics pipeline permutation is created from, besides the pipeline layout shared by all.
+ */
+struct GraphicsPipelineKey
+{
+    ShaderSet shaderSet{ShaderSet::PerFragmentLight};
+    VertexLayout vertexLayout{VertexLayout::PositionNormal};
+    VkSampleCountFlagBits sampleCount{VK_SAMPLE_COUNT_1_BIT};
+    VkCullModeFlags cullMode{VK_CULL_MODE_BACK_BIT};
+    VkPolygonMode polygonMode{VK_POLYGON_MODE_FILL};
+    VkFormat colorFormat{VK_FORMAT_UNDEFINED}; // Depth format is always RenderTargets::depthFormat
+    bool dynamicRendering{false};              // Attachment formats are declared instead of a render pass
+
+    bool operator==(const GraphicsPipelineKey &other) const = default;
+    bool isCompatible(const GraphicsPipelineKey &other) const; //!< Pipelines of both keys render to the same attachments
+    std::string toString() const;
+};
+
+struct GraphicsPipelineKeyHash
+{
+    size_t operator()(const GraphicsPipelineKey &key) const;
+};
+
+/**
+ * \brief Graphics pipeline permutations built lazily on the job system and cached for the lifetime of the manager.
+ *
+ * With VK_EXT_graphics_pipeline_library a permutation is linked from vertex input, pre-rasterization, fragment shader
+ * and fragment output libraries, each cached on its own, so a new permutation mostly reuses already compiled parts.
+ * The fast linked pipeline is replaced by a link time optimized one in the background. Without the extension the
+ * whole pipeline is compiled in one background job. Replaced pipelines are destroyed with the manager, frames in
+ * flight may still use them.
+ */
+class PipelineManager
+{
+  public:
+    PipelineManager(std::shared_ptr<Device> &device, std::shared_ptr<JobSystem> &jobSystem, PipelineCache &pipelineCache,
+                    VkPipelineLayout pipelineLayout);
+    PipelineManager(const PipelineManager &) = delete;
+    PipelineManager &operator=(const PipelineManager &) = delete;
+    ~PipelineManager();
+
+    //! Takes ownership of the shader modules, they are kept as long as permutations may be built from them
+    void setShaderSet(ShaderSet shaderSet, VkShaderModule vertexShader, VkShaderModule fragmentShader);
+    void setVertexLayout(VertexLayout vertexLayout, const std::vector<VkVertexInputBindingDescription> &bindings,
+                         const std::vector<VkVertexInputAttributeDescription> &attributes);
+    void setRenderPass(std::shared_ptr<RenderPass> renderPass); //!< Used by keys without dynamic rendering
+
+    VkPipeline get(const GraphicsPipelineKey &key);         //!< VK_NULL_HANDLE while the permutation is being built
+    VkPipeline getBlocking(const GraphicsPipelineKey &key); //!< Helps the job system until the permutation is built
+
+    bool isUsingLibraries() const;
+
+  private:
+    enum LibraryPart
+    {
+        VertexInputLibrary,
+        PreRasterizationLibrary,
+        FragmentShaderLibrary,
+        FragmentOutputLibrary,
+        LibraryPartCount
+    };
+
+    struct Pipeline
+    {
+        VkPipeline handle{VK_NULL_HANDLE}; // Fast linked or monolithic, then link time optimized
+        std::shared_future<void> ready;    // Signalled once the first handle is stored
+    };
+
+    struct ShaderModules
+    {
+        VkShaderModule vertex{VK_NULL_HANDLE};
+        VkShaderModule fragment{VK_NULL_HANDLE};
+    };
+
+    struct VertexInput
+    {
+        std::vector<VkVertexInputBindingDescription> bindings;
+        std::vector<VkVertexInputAttributeDescription> attributes;
+    };
+
+    struct PipelineState;
+
+    std::shared_ptr<Device> device;
+    std::shared_ptr<JobSystem> jobSystem;
+    PipelineCache &pipelineCache;
+    VkPipelineLayout pipelineLayout;
+    std::shared_ptr<RenderPass> renderPass;
+    bool useLibraries{false};
+
+    std::array<ShaderModules, static_cast<size_t>(ShaderSet::Count)> shaderModules{};
+    std::array<VertexInput, static_cast<size_t>(VertexLayout::Count)> vertexInputs{};
+
+    // Guards everything below, jobs of the job system create pipelines concurrently
+    std::mutex mutex;
+    std::unordered_map<GraphicsPipelineKey, Pipeline, GraphicsPipelineKeyHash> pipelines;
+    // Libraries are keyed by the pipeline key with fields not affecting the part reset, see getLibraryKey()
+    std::array<std::unordered_map<GraphicsPipelineKey, std::shared_future<VkPipeline>, GraphicsPipelineKeyHash>,
+               LibraryPartCount>
+        libraries;
+    std::vector<VkPipeline> createdPipelines;   // Every pipeline and library, destroyed with the manager
+    std::vector<std::shared_future<void>> jobs; // Awaited by the destructor
+
+    GSGE_DEBUGGER_INSTANCE_DECL;
+
+    void build(const GraphicsPipelineKey &key, std::shared_ptr<RenderPass> renderPass, std::promise<void> &ready);
+    void optimize(const GraphicsPipelineKey &key, const std::array<VkPipeline, LibraryPartCount> &parts);
+    void store(const GraphicsPipelineKey &key, VkPipeline pipeline, const char *stage, float seconds);
+
+    VkPipeline createPipeline(const GraphicsPipelineKey &key, const std::shared_ptr<RenderPass> &renderPass);
+    VkPipeline getLibrary(LibraryPart part, const GraphicsPipelineKey &key, const std::shared_ptr<RenderPass> &renderPass);
+    VkPipeline createLibrary(LibraryPart part, const GraphicsPipelineKey &key, const std::shared_ptr<RenderPass> &renderPass);
+    VkPipeline linkLibraries(const std::array<VkPipeline, LibraryPartCount> &parts, bool optimized);
+    static GraphicsPipelineKey getLibraryKey(LibraryPart part, const GraphicsPipelineKey &key);
+};
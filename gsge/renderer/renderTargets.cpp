@@ -0,0 +1,157 @@
+#include "renderTargets.h"
+
+RenderTargets::RenderTargets(std::shared_ptr<Device> &device, std::shared_ptr<Swapchain> &swapchain)
+    : device(device), swapchain(swapchain)
+{
+    msaaEnabledAtCreation = settings.Renderer.msaa.enabled;
+    sampleCount = msaaEnabledAtCreation ? settings.Renderer.msaa.sampleCount : VK_SAMPLE_COUNT_1_BIT;
+
+    if (msaaEnabledAtCreation)
+        createMultisampleResources();
+    createDepthResources();
+
+    SPDLOG_TRACE("[Render targets] Created");
+}
+
+RenderTargets::~RenderTargets()
+{
+    if (msaaEnabledAtCreation)
+    {
+        for (size_t i = 0; i < multisampleImage.size(); ++i)
+        {
+            vkDestroyImageView(*device, multisampleImageView[i], nullptr);
+            vmaDestroyImage(device->getAllocator(), multisampleImage[i], multisampleImageAllocation[i]);
+        }
+    }
+
+    for (size_t i = 0; i < depthImage.size(); ++i)
+    {
+        vkDestroyImageView(*device, depthImageView[i], nullptr);
+        vmaDestroyImage(device->getAllocator(), depthImage[i], depthImageAllocation[i]);
+    }
+
+    SPDLOG_TRACE("[Render targets] Destroyed");
+}
+
+VkImageView &RenderTargets::getDepthImageView(size_t index)
+{
+    return depthImageView[index];
+}
+
+VkImageView &RenderTargets::getMultisampleImageView(size_t index)
+{
+    return multisampleImageView[index];
+}
+
+VkImage &RenderTargets::getDepthImage(size_t index)
+{
+    return depthImage[index];
+}
+
+VkImage &RenderTargets::getMultisampleImage(size_t index)
+{
+    return multisampleImage[index];
+}
+
+bool RenderTargets::isMultisampled() const
+{
+    return msaaEnabledAtCreation;
+}
+
+VkSampleCountFlagBits RenderTargets::getSampleCount() const
+{
+    return sampleCount;
+}
+
+void RenderTargets::createDepthResources()
+{
+    uint32_t imageCount = swapchain->getImageCount();
+
+    depthImage.resize(imageCount);
+    depthImageView.resize(imageCount);
+    depthImageAllocation.resize(imageCount);
+
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        createImage(swapchain->getExtent().width, swapchain->getExtent().height, sampleCount, depthFormat,
+                    VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage[i], depthImageAllocation[i], VK_IMAGE_LAYOUT_UNDEFINED);
+        depthImageView[i] = createImageView(depthImage[i], depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+    }
+
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(depthImage, "Depth image");
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(depthImageView, "Depth image view");
+    SPDLOG_TRACE("[Render targets / Depth resources] Created");
+}
+
+void RenderTargets::createMultisampleResources()
+{
+    uint32_t imageCount = swapchain->getImageCount();
+
+    multisampleImage.resize(imageCount);
+    multisampleImageView.resize(imageCount);
+    multisampleImageAllocation.resize(imageCount);
+
+    for (size_t i = 0; i < imageCount; ++i)
+    {
+        createImage(swapchain->getExtent().width, swapchain->getExtent().height, sampleCount,
+                    swapchain->getImageFormat(), VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, multisampleImage[i], multisampleImageAllocation[i],
+                    VK_IMAGE_LAYOUT_UNDEFINED);
+        multisampleImageView[i] = createImageView(multisampleImage[i], swapchain->getImageFormat(), VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(multisampleImage, "Multisample image");
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(multisampleImageView, "Multisample image view");
+    SPDLOG_TRACE("[Render targets / Multisample resources] Created");
+}
+
+/**
+ * \brief Create image with memory from the device allocator.
+ *
+ * Attachments are recreated with the swapchain and can be large, so each gets a dedicated allocation. Freeing them on
+ * resize or MSAA toggle then releases whole memory blocks instead of leaving holes in shared blocks.
+ */
+void RenderTargets::createImage(uint32_t width, uint32_t height, VkSampleCountFlagBits samples, VkFormat format,
+                                VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image,
+                                VmaAllocation &imageAllocation, VkImageLayout initialLayout)
+{
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = {.width = width, .height = height, .depth = 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = samples,
+        .tiling = tiling,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = initialLayout,
+    };
+
+    VmaAllocationCreateInfo allocationInfo{
+        .flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .requiredFlags = properties,
+    };
+
+    GSGE_CHECK_RESULT(vmaCreateImage(device->getAllocator(), &imageInfo, &allocationInfo, &image, &imageAllocation, nullptr));
+}
+
+VkImageView RenderTargets::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+{
+    VkImageViewCreateInfo viewInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .subresourceRange = {.aspectMask = aspectFlags, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1},
+    };
+
+    VkImageView imageView;
+    GSGE_CHECK_RESULT(vkCreateImageView(*device, &viewInfo, nullptr, &imageView));
+    
+    return imageView;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "swapchain.h"
+#include "debugger.h"
+#include "settings.h"
+#include "core/tools.h"
+
+class Swapchain;
+
+/**
+ * \brief Depth and multisample color images rendered to along with each swapchain image.
+ *
+ * Owned separately from Framebuffer, so that dynamic rendering, which has no render pass and framebuffer objects,
+ * recreates only these images on resize and MSAA toggle.
+ */
+class RenderTargets
+{
+  public:
+    static constexpr VkFormat depthFormat = VK_FORMAT_D32_SFLOAT; // TODO: Add method to find supported depth format
+
+    RenderTargets(std::shared_ptr<Device> &device, std::shared_ptr<Swapchain> &swapchain);
+    RenderTargets(const RenderTargets &) = delete;
+    RenderTargets &operator=(const RenderTargets &) = delete;
+    ~RenderTargets();
+
+    VkImage &getDepthImage(size_t index);
+    VkImageView &getDepthImageView(size_t index);
+
+    VkImage &getMultisampleImage(size_t index);
+    VkImageView &getMultisampleImageView(size_t index);
+
+    bool isMultisampled() const;                  //!< MSAA was enabled when the images were created
+    VkSampleCountFlagBits getSampleCount() const; //!< Sample count of depth and multisample images
+
+  private:
+    GSGE_DEBUGGER_INSTANCE_DECL;
+    GSGE_SETTINGS_INSTANCE_DECL;
+
+    // Depth buffer resources
+    std::vector<VkImage> depthImage;
+    std::vector<VmaAllocation> depthImageAllocation;
+    std::vector<VkImageView> depthImageView;
+
+    // For MSAA - image that multisampled color image is being resolved to
+    std::vector<VkImage> multisampleImage;
+    std::vector<VmaAllocation> multisampleImageAllocation;
+    std::vector<VkImageView> multisampleImageView;
+    bool msaaEnabledAtCreation;
+    VkSampleCountFlagBits sampleCount;
+
+    std::shared_ptr<Device> device;
+    std::shared_ptr<Swapchain> swapchain;
+
+    void createDepthResources();
+    void createMultisampleResources();
+
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    void createImage(uint32_t width, uint32_t height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling,
+                     VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VmaAllocation &imageAllocation,
+                     VkImageLayout initialLayout);
+};
@@ -1,5 +1,7 @@
 #include "settings.h"
 
+#include <algorithm>
+
 Settings::Settings()
 {
 }
@@ -69,6 +71,206 @@ void Settings::parseCmdParams(std::vector<std::string_view> params)
                 SPDLOG_WARN("[Settings] Invalid value for --height parameter: {}", param);
             }
         }
+        else if (param.find("--threads=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                Jobs.threadCount = std::stoi(param.data());
+                SPDLOG_INFO("[Settings] Command line parameter detected - Job system threads: {}", Jobs.threadCount);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --threads parameter: {}", param);
+            }
+        }
+        else if (param.find("--frames-in-flight=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                Renderer.framesInFlight = std::max(std::stoi(param.data()), 1);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Frames in flight: {}", Renderer.framesInFlight);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --frames-in-flight parameter: {}", param);
+            }
+        }
+        else if (param.find("--swapchain-images=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                Renderer.swapchainImageCount = std::max(std::stoi(param.data()), 0);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Swapchain images: {}", Renderer.swapchainImageCount);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --swapchain-images parameter: {}", param);
+            }
+        }
+        else if (param.find("--gpu-driven") != param.npos)
+        {
+            Renderer.gpuDriven = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - GPU-driven rendering");
+        }
+        else if (param.find("--dynamic-rendering") != param.npos)
+        {
+            Renderer.dynamicRendering = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Dynamic rendering");
+        }
+        else if (param.find("--staging-transforms") != param.npos)
+        {
+            Renderer.directTransformUpload = false;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Transform matrices uploaded through staging buffer");
+        }
+        else if (param.find("--serial-recording") != param.npos)
+        {
+            Renderer.parallelRecording = false;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Draws recorded on the main thread only");
+        }
+        else if (param.find("--per-vertex-lighting") != param.npos)
+        {
+            Renderer.perVertexLighting = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Per vertex lighting");
+        }
+        else if (param.find("--gpu-transforms") != param.npos)
+        {
+            Renderer.gpuTransforms = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Transforms integrated on the GPU");
+        }
+        else if (param.find("--headless") != param.npos)
+        {
+            Headless.enabled = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Headless offscreen rendering");
+        }
+        else if (param.find("--frames=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                Headless.frameCount = std::max(std::stoi(param.data()), 1);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Headless frames: {}", Headless.frameCount);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --frames parameter: {}", param);
+            }
+        }
+        else if (param.find("--screenshot=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            Headless.imagePath = param;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Last headless frame written to {}", Headless.imagePath);
+        }
+        else if (param.find("--entities=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                BenchScene.entityCount = std::max(std::stoi(param.data()), 1);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Bench scene entities: {}", BenchScene.entityCount);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --entities parameter: {}", param);
+            }
+        }
+        else if (param.find("--unique-meshes=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                BenchScene.uniqueMeshCount = std::max(std::stoi(param.data()), 1);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Bench scene unique meshes: {}",
+                            BenchScene.uniqueMeshCount);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --unique-meshes parameter: {}", param);
+            }
+        }
+        else if (param.find("--motion-fraction=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                BenchScene.motionFraction = std::clamp(std::stof(param.data()), 0.0f, 1.0f);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Bench scene motion fraction: {}",
+                            BenchScene.motionFraction);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --motion-fraction parameter: {}", param);
+            }
+        }
+        else if (param.find("--camera-path=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            if (param == "static")
+                BenchScene.cameraPath = ESettings::CameraPath::Static;
+            else if (param == "orbit")
+                BenchScene.cameraPath = ESettings::CameraPath::Orbit;
+            else if (param == "flythrough")
+                BenchScene.cameraPath = ESettings::CameraPath::Flythrough;
+            else
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --camera-path parameter: {}", param);
+                continue;
+            }
+            SPDLOG_INFO("[Settings] Command line parameter detected - Bench scene camera path: {}", param);
+        }
+        else if (param.find("--bench-output=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            BenchScene.outputPath = param;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Bench results written to {}", BenchScene.outputPath);
+        }
+        else if (param.find("--frame-history=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                FrameStats.historySize = std::max(std::stoi(param.data()), 1);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Frame history: {}", FrameStats.historySize);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --frame-history parameter: {}", param);
+            }
+        }
+        else if (param.find("--hitch-threshold=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            try
+            {
+                FrameStats.hitchThreshold = std::max(std::stof(param.data()), 0.0f);
+                SPDLOG_INFO("[Settings] Command line parameter detected - Hitch threshold: {} ms",
+                            FrameStats.hitchThreshold);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                SPDLOG_WARN("[Settings] Invalid value for --hitch-threshold parameter: {}", param);
+            }
+        }
+        else if (param.find("--frame-stats-output=") != param.npos)
+        {
+            param.remove_prefix(std::min(param.find_last_of('=') + 1, param.size()));
+            FrameStats.outputPath = param;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Frame statistics written to {}",
+                        FrameStats.outputPath);
+        }
+        else if (param.find("--bench-transforms") != param.npos)
+        {
+            Benchmark.transformScaling = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Transform scaling benchmark");
+        }
+        else if (param.find("--bench-assets") != param.npos)
+        {
+            Benchmark.assetLoading = true;
+            SPDLOG_INFO("[Settings] Command line parameter detected - Asset loading benchmark");
+        }
         else
         {
             SPDLOG_WARN("[Settings] Invalid parameter: {}", param);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 #include <string_view>
 
@@ -48,10 +49,82 @@ class Settings
             bool enabled{false};
 			VkSampleCountFlagBits sampleCount{VK_SAMPLE_COUNT_4_BIT};
 		} msaa;
+
+        // Frustum culling in a compute shader and one indirect draw instead of an instanced draw call per mesh.
+        // Falls back to CPU recorded draws when the device lacks drawIndirectCount
+        bool gpuDriven{false};
+
+        // Write transform matrices straight into the storage buffer when it lands in host visible device local memory
+        // (resizable BAR, integrated GPUs). Staging copy on the transfer queue otherwise
+        bool directTransformUpload{true};
+
+        // Begin rendering with vkCmdBeginRendering instead of render pass and framebuffer objects, so resize and MSAA
+        // toggle recreate only the attachment images. Falls back to the render pass when the feature is missing
+        bool dynamicRendering{false};
+
+        // Split CPU recorded draws between job system threads, each recording its own secondary command buffer.
+        // Scenes with few draw groups are still recorded inline
+        bool parallelRecording{true};
+
+        // Light in the vertex shader instead of the fragment shader. Pipelines of both shader sets are built in the
+        // background, so switching at runtime does not wait for compilation
+        bool perVertexLighting{false};
+
+        // Integrate moving transforms in a compute shader on the async compute queue instead of on the job system.
+        // Motion is handed over to the GPU at startup, the CPU only uploads static transforms afterwards
+        bool gpuTransforms{false};
+
+        // Frames recorded while the GPU works on previous ones. 1 gives the lowest latency, 3 the highest throughput
+        uint32_t framesInFlight{2};
+        // Swapchain images requested, 0 - one more than the surface minimum. Clamped to the surface limits
+        uint32_t swapchainImageCount{0};
         //bool enableMSAA{false};
 		//VkSampleCountFlagBits msaaSampleCount{VK_SAMPLE_COUNT_4_BIT};
 	} Renderer;
 
+    // Job system related settings
+    struct Jobs
+    {
+        uint32_t threadCount{0}; // 0 - use all hardware threads
+    } Jobs;
+
+    // Offscreen rendering without window, surface and presentation, e.g. for benchmarks on machines without a display.
+    // Renders a fixed number of frames with a fixed timestep as fast as possible and exits
+    struct Headless
+    {
+        bool enabled{false};
+        uint32_t frameCount{600};
+        std::string imagePath; // Last frame is written to this PNG file, empty - not written
+    } Headless;
+
+    // Generated scene rendered by gsge_bench instead of the showcase scene. The scene advances by a fixed timestep for
+    // Headless.frameCount frames, frame time statistics are written to outputPath
+    struct BenchScene
+    {
+        bool enabled{false};                     // Set by gsge_bench, not by a command line parameter
+        uint32_t entityCount{10'000};
+        uint32_t uniqueMeshCount{16};            // Entities are spread evenly between the meshes
+        float motionFraction{0.5f};              // Share of entities moving every frame, the rest stays static
+        ESettings::CameraPath cameraPath{ESettings::CameraPath::Orbit};
+        std::string outputPath{"gsge_bench.json"}; // .csv - CSV, otherwise JSON
+    } BenchScene;
+
+    // Frame time recorder of the interactive app. Percentiles are logged and frames exported to outputPath on key H
+    // and on exit, the histogram goes next to it
+    struct FrameStats
+    {
+        uint32_t historySize{8192};  // Frames kept in the ring buffer
+        float hitchThreshold{33.3f}; // Milliseconds, slower frames are logged as hitches
+        std::string outputPath{"gsge_frames.csv"};
+    } FrameStats;
+
+    // Built-in benchmarks, app exits after running them
+    struct Benchmark
+    {
+        bool transformScaling{false};
+        bool assetLoading{false};
+    } Benchmark;
+
 
   private:
     // Private constructor to prevent instancing
@@ -17,6 +17,11 @@ Swapchain::Swapchain(std::shared_ptr<Device> &device, std::shared_ptr<Window> &w
     initializeSwapchainImages();
 }
 
+Swapchain::Swapchain(std::shared_ptr<Device> &device) : device(device)
+{
+    createOffscreenImages();
+}
+
 Swapchain::~Swapchain()
 {
     for (auto imageView : imageViews)
@@ -24,7 +29,14 @@ Swapchain::~Swapchain()
         vkDestroyImageView(*device, imageView, nullptr);
     }
 
-    vkDestroySwapchainKHR(*device, swapchain, nullptr);
+    for (size_t i = 0; i < imageAllocations.size(); i++)
+    {
+        vmaDestroyImage(device->getAllocator(), images[i], imageAllocations[i]);
+    }
+
+    // VK_KHR_swapchain is not enabled for offscreen rendering
+    if (swapchain != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(*device, swapchain, nullptr);
 
     SPDLOG_TRACE("[Swapchain] Destroyed");
 }
@@ -55,7 +67,9 @@ void Swapchain::createSwapchain()
     VkPresentModeKHR presentMode = chooseSwapPresentMode();
     VkExtent2D swapExtent = chooseSwapExtent();
 
-    colorImageCount = device->getSurfaceCapabilities().minImageCount + 1;
+    colorImageCount = settings.Renderer.swapchainImageCount > 0 ? settings.Renderer.swapchainImageCount
+                                                                : device->getSurfaceCapabilities().minImageCount + 1;
+    colorImageCount = std::max(colorImageCount, device->getSurfaceCapabilities().minImageCount);
     if (device->getSurfaceCapabilities().maxImageCount > 0 && colorImageCount > device->getSurfaceCapabilities().maxImageCount)
     {
         colorImageCount = device->getSurfaceCapabilities().maxImageCount;
@@ -87,13 +101,62 @@ void Swapchain::createSwapchain()
     };
     GSGE_CHECK_RESULT(vkCreateSwapchainKHR(*device, &createInfo, nullptr, &swapchain));
 
+    // minImageCount is a lower bound, the implementation may create more images
+    GSGE_CHECK_RESULT(vkGetSwapchainImagesKHR(*device, swapchain, &colorImageCount, nullptr));
     images.resize(colorImageCount);
     imageViews.resize(colorImageCount);
 
     extent = swapExtent;
     imageFormat = surfaceFormat.format;
 
-    SPDLOG_TRACE("[Swapchain] Created");
+    SPDLOG_TRACE("[Swapchain] Created with {} images", colorImageCount);
+}
+
+/**
+ * \brief Create offscreen color images in place of swapchain images, one per frame in flight.
+ *
+ * RGBA byte order, so the last frame is copied out as is. Images are attachments and copy sources only.
+ */
+void Swapchain::createOffscreenImages()
+{
+    uint32_t imageCount = std::max(settings.Renderer.framesInFlight, 1u);
+
+    imageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+    extent = {settings.displaySize.width, settings.displaySize.height};
+
+    images.resize(imageCount);
+    imageViews.resize(imageCount);
+    imageAllocations.resize(imageCount);
+
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = imageFormat,
+        .extent = {.width = extent.width, .height = extent.height, .depth = 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    VmaAllocationCreateInfo allocationInfo{
+        .flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
+
+    for (size_t i = 0; i < imageCount; i++)
+    {
+        GSGE_CHECK_RESULT(
+            vmaCreateImage(device->getAllocator(), &imageInfo, &allocationInfo, &images[i], &imageAllocations[i], nullptr));
+        imageViews[i] = createImageView(images[i], imageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(images, "Offscreen image");
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(imageViews, "Offscreen image view");
+    SPDLOG_TRACE("[Swapchain] Created {} offscreen images {}x{}", imageCount, extent.width, extent.height);
 }
 
 VkSurfaceFormatKHR Swapchain::chooseSwapSurfaceFormat()
@@ -173,6 +236,16 @@ VkExtent2D &Swapchain::getExtent()
     return extent;
 }
 
+bool Swapchain::isOffscreen() const
+{
+    return swapchain == VK_NULL_HANDLE;
+}
+
+VkImageLayout Swapchain::getFinalLayout() const
+{
+    return isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 VkImageView Swapchain::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
 {
     VkImageViewCreateInfo viewInfo{
@@ -15,10 +15,17 @@
 
 class RenderPass;
 
+/**
+ * \brief Swapchain of the window surface, or offscreen images standing in for it in headless mode.
+ *
+ * Offscreen images are created one per frame in flight, the image of a frame is free once the frame retires. They
+ * end up in TRANSFER_SRC_OPTIMAL after rendering, so the last frame can be copied out instead of being presented.
+ */
 class Swapchain
 {
   public:
     Swapchain(std::shared_ptr<Device> &device, std::shared_ptr<Window> &window, std::shared_ptr<Surface> &surface);
+    explicit Swapchain(std::shared_ptr<Device> &device); //!< Offscreen images sized by Settings::displaySize
     Swapchain(const Swapchain &) = delete;
     Swapchain &operator=(const Swapchain &) = delete;
     ~Swapchain();
@@ -28,6 +35,8 @@ class Swapchain
     VkFormat getImageFormat() const;
     VkImage &getImage(uint32_t index);
     VkImageView &getImageView(uint32_t index);
+    bool isOffscreen() const;
+    VkImageLayout getFinalLayout() const; //!< Layout images are left in after rendering, PRESENT_SRC_KHR unless offscreen
 
     inline operator VkSwapchainKHR() const
     {
@@ -35,13 +44,14 @@ class Swapchain
     }
 
   private:
-    VkSwapchainKHR swapchain;
+    VkSwapchainKHR swapchain{VK_NULL_HANDLE};
     VkFormat imageFormat = VK_FORMAT_B8G8R8A8_SRGB;
     VkExtent2D extent;
 
     // Color images that shaders render to
     std::vector<VkImage> images;
     std::vector<VkImageView> imageViews;
+    std::vector<VmaAllocation> imageAllocations; // Offscreen images only, swapchain images belong to the swapchain
 
     std::shared_ptr<Device> device;
     std::shared_ptr<Window> window;
@@ -58,4 +68,5 @@ class Swapchain
     VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
     void initializeSwapchainImages();
     void createSwapchain();
+    void createOffscreenImages();
 };
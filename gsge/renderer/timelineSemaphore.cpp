@@ -0,0 +1,69 @@
+#include "timelineSemaphore.h"
+
+TimelineSemaphore::TimelineSemaphore(std::shared_ptr<Device> &device, const char *name) : device(device)
+{
+    VkSemaphoreTypeCreateInfo typeInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphoreInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &typeInfo,
+    };
+
+    GSGE_CHECK_RESULT(vkCreateSemaphore(*device, &semaphoreInfo, nullptr, &semaphore));
+
+    if (strlen(name))
+        GSGE_DEBUGGER_SET_OBJECT_NAME(semaphore, name);
+
+    SPDLOG_TRACE("[Timeline semaphore] Created {}", name);
+}
+
+TimelineSemaphore::~TimelineSemaphore()
+{
+    vkDestroySemaphore(*device, semaphore, nullptr);
+
+    SPDLOG_TRACE("[Timeline semaphore] Destroyed");
+}
+
+uint64_t TimelineSemaphore::next()
+{
+    return ++lastValue;
+}
+
+uint64_t TimelineSemaphore::getLastValue() const
+{
+    return lastValue;
+}
+
+uint64_t TimelineSemaphore::getCompletedValue() const
+{
+    uint64_t value;
+    GSGE_CHECK_RESULT(vkGetSemaphoreCounterValue(*device, semaphore, &value));
+
+    return value;
+}
+
+void TimelineSemaphore::wait(uint64_t value) const
+{
+    VkSemaphoreWaitInfo waitInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &semaphore,
+        .pValues = &value,
+    };
+
+    GSGE_CHECK_RESULT(vkWaitSemaphores(*device, &waitInfo, UINT64_MAX));
+}
+
+VkSemaphoreSubmitInfo TimelineSemaphore::getSubmitInfo(uint64_t value, VkPipelineStageFlags2 stageMask) const
+{
+    return {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = semaphore,
+        .value = value,
+        .stageMask = stageMask,
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "debugger.h"
+#include "core/tools.h"
+
+/**
+ * \brief Timeline semaphore of one queue, every submit to the queue signals the next value.
+ *
+ * Values only grow, so a single semaphore tells how far the queue got. Other queues wait on the value they depend on
+ * and the CPU waits on exactly the value it needs, instead of a binary semaphore and a fence per frame in flight.
+ */
+class TimelineSemaphore
+{
+  public:
+    TimelineSemaphore(std::shared_ptr<Device> &device, const char *name = "");
+    TimelineSemaphore(const TimelineSemaphore &) = delete;
+    TimelineSemaphore &operator=(const TimelineSemaphore &) = delete;
+    ~TimelineSemaphore();
+
+    uint64_t next();                    //!< Value to be signalled by the next submit
+    uint64_t getLastValue() const;      //!< Value signalled by the latest submit
+    uint64_t getCompletedValue() const; //!< Value the queue has reached
+    void wait(uint64_t value) const;    //!< Block until the queue reaches value, returns at once for reached values
+
+    VkSemaphoreSubmitInfo getSubmitInfo(uint64_t value, VkPipelineStageFlags2 stageMask) const;
+
+    inline operator VkSemaphore()
+    {
+        return semaphore;
+    }
+
+  private:
+    std::shared_ptr<Device> device;
+
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t lastValue{0};
+
+    GSGE_DEBUGGER_INSTANCE_DECL;
+};
@@ -0,0 +1,87 @@
+#include "uploadRing.h"
+
+UploadRing::UploadRing(std::shared_ptr<Device> &device, uint32_t frameCount, VkDeviceSize frameSize)
+    : device(device), frameCount(frameCount)
+{
+    VkDeviceSize alignment = getUniformAlignment();
+    this->frameSize = (frameSize + alignment - 1) / alignment * alignment;
+
+    // Slices are read by copies on the transfer queue and as uniforms on the graphics queue
+    std::array<uint32_t, 2> queueFamilyIndices = {device->getGraphicsQueueFamilyIdx(), device->getTransferQueueFamilyIdx()};
+    bool concurrent = queueFamilyIndices[0] != queueFamilyIndices[1];
+
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = this->frameSize * frameCount,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0,
+        .pQueueFamilyIndices = concurrent ? queueFamilyIndices.data() : nullptr,
+    };
+
+    VmaAllocationCreateInfo allocationInfo{
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO,
+        .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+    };
+
+    VmaAllocationInfo mappedInfo;
+    GSGE_CHECK_RESULT(
+        vmaCreateBuffer(device->getAllocator(), &bufferInfo, &allocationInfo, &buffer, &allocation, &mappedInfo));
+    mappedData = static_cast<std::byte *>(mappedInfo.pMappedData);
+
+    GSGE_DEBUGGER_SET_OBJECT_NAME(buffer, "Upload ring");
+    SPDLOG_TRACE("[Upload ring] Created, {} frames of {} bytes", frameCount, this->frameSize);
+}
+
+UploadRing::~UploadRing()
+{
+    vmaDestroyBuffer(device->getAllocator(), buffer, allocation);
+
+    SPDLOG_TRACE("[Upload ring] Destroyed");
+}
+
+void UploadRing::beginFrame(uint32_t frame)
+{
+    frameBegin = (frame % frameCount) * frameSize;
+    head = 0;
+}
+
+/**
+ * \brief Hand out the next slice of the current frame's partition.
+ *
+ * Slices stay valid until the partition is recycled by beginFrame() of the same frame. Throws when the partition is
+ * exhausted, callers uploading more than getFrameSize() have to split their data.
+ */
+UploadRing::Slice UploadRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkDeviceSize offset = (frameBegin + head + alignment - 1) / alignment * alignment;
+
+    if (offset + size > frameBegin + frameSize)
+        throw std::runtime_error("upload ring frame partition exhausted!");
+
+    head = offset + size - frameBegin;
+
+    return {
+        .buffer = buffer,
+        .offset = offset,
+        .size = size,
+        .data = mappedData + offset,
+    };
+}
+
+void UploadRing::flush(const Slice &slice)
+{
+    // VMA aligns the range to nonCoherentAtomSize and skips coherent memory
+    GSGE_CHECK_RESULT(vmaFlushAllocation(device->getAllocator(), allocation, slice.offset, slice.size));
+}
+
+VkDeviceSize UploadRing::getFrameSize() const
+{
+    return frameSize;
+}
+
+VkDeviceSize UploadRing::getUniformAlignment() const
+{
+    return std::max<VkDeviceSize>(device->getPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment, 16);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "debugger.h"
+#include "core/tools.h"
+
+/**
+ * \brief Persistently mapped host buffer for per-frame uploads, split into one partition per frame in flight.
+ *
+ * Each partition is a linear allocator handing out aligned slices for uniform data, transform matrices and ad-hoc
+ * staging copies. A partition is recycled by beginFrame() once the graphics timeline has reached the value of its
+ * frame, so nothing is mapped, unmapped or allocated in the frame loop.
+ */
+class UploadRing
+{
+  public:
+    struct Slice
+    {
+        VkBuffer buffer;     // Ring buffer, same for every slice
+        VkDeviceSize offset; // Offset of the slice in the ring buffer
+        VkDeviceSize size;
+        void *data;          // Host address of the slice
+    };
+
+    UploadRing(std::shared_ptr<Device> &device, uint32_t frameCount, VkDeviceSize frameSize);
+    UploadRing(const UploadRing &) = delete;
+    UploadRing &operator=(const UploadRing &) = delete;
+    ~UploadRing();
+
+    void beginFrame(uint32_t frame); //!< Recycle partition of the frame, its timeline value must be reached
+    Slice allocate(VkDeviceSize size, VkDeviceSize alignment);
+    void flush(const Slice &slice); //!< Make host writes visible, no-op on coherent memory
+
+    VkDeviceSize getFrameSize() const;
+    VkDeviceSize getUniformAlignment() const; //!< Alignment of slices bound as uniform buffers
+
+    inline operator VkBuffer()
+    {
+        return buffer;
+    }
+
+  private:
+    std::shared_ptr<Device> device;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    std::byte *mappedData = nullptr;
+
+    uint32_t frameCount;
+    VkDeviceSize frameSize;     // Size of one partition, multiple of the uniform alignment
+    VkDeviceSize frameBegin{0}; // Offset of the current partition
+    VkDeviceSize head{0};       // Next free byte of the current partition, relative to frameBegin
+
+    GSGE_DEBUGGER_INSTANCE_DECL;
+};
@@ -1,9 +1,47 @@
 #include "scene.h"
 
+#include <format>
+
+#include <glm/gtc/constants.hpp>
+
+/**
+ * \brief Torus around the y axis with major radius 1, triangles wound like imported meshes.
+ */
+static void generateTorus(uint32_t majorSegments, uint32_t minorSegments, float minorRadius, std::vector<glm::vec3> &vertices,
+                          std::vector<glm::vec3> &normals, std::vector<glm::u32> &indices)
+{
+    for (uint32_t i = 0; i < majorSegments; ++i)
+    {
+        float u = glm::two_pi<float>() * i / majorSegments;
+        for (uint32_t j = 0; j < minorSegments; ++j)
+        {
+            float v = glm::two_pi<float>() * j / minorSegments;
+            glm::vec3 normal(cos(v) * cos(u), sin(v), cos(v) * sin(u));
+            vertices.push_back(glm::vec3(cos(u), 0.0f, sin(u)) + minorRadius * normal);
+            normals.push_back(normal);
+        }
+    }
+
+    // Rings wrap around in both directions, so the last segments reuse the first vertices
+    for (uint32_t i = 0; i < majorSegments; ++i)
+        for (uint32_t j = 0; j < minorSegments; ++j)
+        {
+            uint32_t a = i * minorSegments + j;
+            uint32_t b = (i + 1) % majorSegments * minorSegments + j;
+            uint32_t c = i * minorSegments + (j + 1) % minorSegments;
+            uint32_t d = (i + 1) % majorSegments * minorSegments + (j + 1) % minorSegments;
+            indices.insert(indices.end(), {a, b, c, b, d, c});
+        }
+}
+
 void scene::initScene()
 {
     using namespace DirectX;   
 
+    // Keep mesh reference counts in sync with mesh components
+    registry.on_construct<component::mesh>().connect<&scene::onMeshConstruct>(*this);
+    registry.on_destroy<component::mesh>().connect<&scene::onMeshDestroy>(*this);
+
     // Camera object
     mainCamera.setPosition(glm::vec3(25.f, -5.0f, -60.0f));
 
@@ -17,6 +55,15 @@ void scene::initScene()
     simpleCube = registry.create();
     lightGizmo = registry.create();
 
+    loadModel(suzanne, "models/suzanne.fbx");
+    loadModel(suzanne_smooth, "models/suzanne_smooth.fbx");
+    loadModel(icoSphere, "models/icoSphere.fbx");
+    loadModel(testCube, "models/testCube.fbx");
+    loadModel(companionCube, "models/CompanionCube.fbx");
+    loadModel(squareFloor, "models/squareFloor.fbx");
+    loadModel(simpleCube, "models/simpleCube.fbx");
+    loadModel(lightGizmo, "models/icoSphere.fbx");
+
     size_t i = 0;
     for (size_t y = 0; y < c_arraySize; y++)
         for (size_t x = 0; x < c_arraySize; x++)
@@ -41,15 +88,6 @@ void scene::initScene()
     registry.emplace<component::name>(simpleCube, "simpleCube");
     registry.emplace<component::name>(lightGizmo, "lightGizmo");
 
-    registry.emplace<component::mesh>(suzanne);
-    registry.emplace<component::mesh>(suzanne_smooth);
-    registry.emplace<component::mesh>(icoSphere);
-    registry.emplace<component::mesh>(testCube);
-    registry.emplace<component::mesh>(companionCube);
-    registry.emplace<component::mesh>(squareFloor);
-    registry.emplace<component::mesh>(simpleCube);
-    registry.emplace<component::mesh>(lightGizmo);
-
     registry.emplace<component::motion>(suzanne, XMFLOAT4A(0.6f, 0.f, 0.f, 0.f),
                                         XMFLOAT4A(0.0f, XMConvertToRadians(60.0f), 0.0f, 0.0f));
     registry.emplace<component::motion>(suzanne_smooth, XMFLOAT4A(0.f, 0.f, 0.f, 0.f),
@@ -79,18 +117,12 @@ void scene::initScene()
     registry.emplace<component::transform>(lightGizmo, XMFLOAT4A(ubo.lightPos.x, ubo.lightPos.y, ubo.lightPos.z, 0.f),
                                            XMFLOAT4A(0, 0, 0, 0), XMFLOAT4A(0.5f, 0.5f, 0.5f, 0.f));
 
-    loadModel(suzanne, "models/suzanne.fbx");
-    loadModel(suzanne_smooth, "models/suzanne_smooth.fbx");
-    loadModel(icoSphere, "models/icoSphere.fbx");
-    loadModel(testCube, "models/testCube.fbx");
-    loadModel(companionCube, "models/CompanionCube.fbx");
-    loadModel(squareFloor, "models/squareFloor.fbx");
-    loadModel(simpleCube, "models/simpleCube.fbx");
-    loadModel(lightGizmo, "models/icoSphere.fbx");
+    // Models are imported on the job system while the rest of the scene is set up
+    waitForModels();
 
     for (int i = 0; i < cubes.size(); i++)
     {
-        registry.emplace<component::mesh>(cubes[i]) = registry.get<component::mesh>(simpleCube);
+        registry.emplace<component::mesh>(cubes[i], registry.get<component::mesh>(simpleCube));
         registry.emplace<component::name>(cubes[i], "cubematrix");
     }
 
@@ -99,62 +131,133 @@ void scene::initScene()
     registry.sort<component::transform, component::motion>();
 }
 
-void scene::loadModel(entt::entity entity, std::string fileName, uint32_t meshId)
+/**
+ * \brief Build a generated scene for benchmarks instead of the showcase scene.
+ *
+ * Entities fill a cube grid and use the generated meshes in turn. Moving entities only rotate, so the scene stays in
+ * the grid bounds, and are spread evenly over the grid. Everything depends on the parameters only, so runs with the
+ * same parameters render the same frames.
+ */
+void scene::initBenchScene(uint32_t entityCount, uint32_t uniqueMeshCount, float motionFraction,
+                           ESettings::CameraPath cameraPath)
 {
-    Assimp::Importer importer;
+    using namespace DirectX;
 
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::u16> indices;
-    std::vector<glm::vec3> vertexNormals;
+    registry.on_construct<component::mesh>().connect<&scene::onMeshConstruct>(*this);
+    registry.on_destroy<component::mesh>().connect<&scene::onMeshDestroy>(*this);
 
-    // Needs to have aiProcess_FlipWindingOrder ENABLED!!!
-    // assimp defaults to CW winding order (and normal calculation) while Vulkan has Y axis inverted causing
-    // normals to be inverted. Proper setting for vulkan renderer in such situation are:
-    // rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    // rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    const aiScene *aiScene =
-        importer.ReadFile(fileName, aiProcess_Triangulate | aiProcess_FlipWindingOrder | aiProcess_JoinIdenticalVertices);
+    std::vector<component::mesh> meshes;
+    meshes.reserve(uniqueMeshCount);
 
-    if (aiScene != nullptr)
+    for (uint32_t i = 0; i < uniqueMeshCount; ++i)
     {
-        SPDLOG_INFO("[Scene] Loaded " + fileName + " model. Meshes: " + std::to_string(aiScene->mNumMeshes) +
-                    ", vertices: " + std::to_string(aiScene->mMeshes[meshId]->mNumVertices));
+        std::vector<glm::vec3> vertices, normals;
+        std::vector<glm::u32> indices;
+
+        // Tessellation and thickness vary with the index, so meshes differ in geometry and not only in name
+        generateTorus(12 + 4 * (i % 8), 8 + 2 * (i / 8 % 8), 0.2f + 0.05f * (i / 64 % 6), vertices, normals, indices);
+        meshes.push_back(assetManager.addGeneratedMesh(std::format("bench/torus_{}", i), vertices, normals, indices));
     }
-    else
+
+    constexpr float spacing = 3.0f;
+    const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(entityCount))));
+
+    for (uint32_t i = 0; i < entityCount; ++i)
     {
-        SPDLOG_ERROR("[Scene] Failed to load model {}. Error: {}", fileName, importer.GetErrorString());
-        throw std::runtime_error("IO error");
+        entt::entity entity = registry.create();
+        uint32_t x = i % gridSize, y = i / gridSize % gridSize, z = i / (gridSize * gridSize);
+
+        auto &transform = registry.emplace<component::transform>(entity);
+        XMStoreFloat4A(&transform.position, {x * spacing, y * spacing, z * spacing, 0.0f});
+
+        if (static_cast<uint64_t>((i + 1) * static_cast<double>(motionFraction)) >
+            static_cast<uint64_t>(i * static_cast<double>(motionFraction)))
+            registry.emplace<component::motion>(
+                entity, XMFLOAT4A(0.f, 0.f, 0.f, 0.f),
+                XMFLOAT4A(XMConvertToRadians(30.0f + i % 7 * 10.0f), XMConvertToRadians(20.0f + i % 5 * 10.0f), 0.f, 0.f));
+
+        registry.emplace<component::mesh>(entity, meshes[i % uniqueMeshCount]);
+        registry.emplace<component::name>(entity, "bench");
     }
 
-    for (size_t i = 0; i < aiScene->mMeshes[meshId]->mNumFaces; i++)
+    registry.sort<component::mesh>([](const entt::entity lhs, const entt::entity rhs) { return lhs < rhs; });
+    registry.sort<component::transform, component::mesh>();
+    registry.sort<component::transform, component::motion>();
+
+    benchCameraPath = cameraPath;
+    benchSceneExtent = gridSize * spacing;
+    benchSceneCenter = glm::vec3((gridSize - 1) * spacing * 0.5f);
+
+    // Orbit keeps the camera 1.2 extents from the center, the farthest corner is less than 2.1 extents away
+    mainCamera.setZFar(std::max(150.0f, benchSceneExtent * 2.5f));
+    updateBenchCamera(0.0f);
+
+    SPDLOG_INFO("[Scene] Bench scene: {} entities on a {}^3 grid, {} unique meshes, motion fraction {}", entityCount,
+                gridSize, uniqueMeshCount, motionFraction);
+}
+
+void scene::updateBenchCamera(float time)
+{
+    constexpr float pathPeriod = 20.0f; // Seconds per orbit or per pass through the scene
+    const float phase = std::fmod(time / pathPeriod, 1.0f);
+    const float distance = benchSceneExtent * 1.2f;
+
+    switch (benchCameraPath)
     {
-        indices.push_back(aiScene->mMeshes[meshId]->mFaces[i].mIndices[0]);
-        indices.push_back(aiScene->mMeshes[meshId]->mFaces[i].mIndices[1]);
-        indices.push_back(aiScene->mMeshes[meshId]->mFaces[i].mIndices[2]);
+    case ESettings::CameraPath::Static:
+        mainCamera.setPosition(benchSceneCenter - glm::vec3(0.0f, 0.0f, distance));
+        mainCamera.lookAt(benchSceneCenter);
+        break;
+    case ESettings::CameraPath::Orbit: {
+        float angle = phase * glm::two_pi<float>();
+        mainCamera.setPosition(benchSceneCenter + distance * glm::vec3(sin(angle), 0.0f, -cos(angle)));
+        mainCamera.lookAt(benchSceneCenter);
+        break;
     }
+    case ESettings::CameraPath::Flythrough: {
+        glm::vec3 start = benchSceneCenter - glm::vec3(benchSceneExtent * 0.6f);
+        glm::vec3 end = benchSceneCenter + glm::vec3(benchSceneExtent * 0.6f);
+        mainCamera.setPosition(glm::mix(start, end, phase));
+        mainCamera.lookAt(end);
+        break;
+    }
+    }
+}
 
-    for (size_t i = 0; i < aiScene->mMeshes[meshId]->mNumVertices; ++i)
+/**
+ * \brief Start importing the model on the job system, the entity gets its mesh component in waitForModels().
+ */
+void scene::loadModel(entt::entity entity, std::string fileName, uint32_t meshId)
+{
+    pendingModels.emplace_back(entity, assetManager.loadMeshAsync(*jobSystem, fileName, meshId));
+}
+
+/**
+ * \brief Wait until all models requested by loadModel() are imported and add mesh components to their entities.
+ *
+ * The calling thread helps with the imports. Import errors are rethrown here.
+ */
+void scene::waitForModels()
+{
+    ZoneScoped;
+
+    for (auto &[entity, mesh] : pendingModels)
     {
-        aiVector3D n = aiScene->mMeshes[meshId]->mNormals[i];
-        vertexNormals.push_back(glm::vec3(n.x, n.y, n.z));
+        jobSystem->wait(mesh);
+        registry.emplace<component::mesh>(entity, mesh.get());
     }
 
-    glm::vec3 *pVertices = reinterpret_cast<glm::vec3 *>(aiScene->mMeshes[meshId]->mVertices);
-    uint32_t nVertices = aiScene->mMeshes[meshId]->mNumVertices;
-    uint32_t nFaces = aiScene->mMeshes[meshId]->mNumFaces;
-
-    glm::u16 *pIndices = indices.data();
-    glm::vec3 *pNormals = vertexNormals.data();
+    pendingModels.clear();
+}
 
-    auto &meshComp = registry.get<component::mesh>(entity);
-    meshComp.vertices.assign(pVertices, pVertices + nVertices);
-    meshComp.indices.assign(pIndices, pIndices + static_cast<size_t>(nFaces) * 3);
-    meshComp.normals.assign(pNormals, pNormals + nVertices);
-    meshComp.nVertices = nVertices;
-    meshComp.nIndices = nFaces * 3;
-    meshComp.nFaces = nFaces;
+void scene::onMeshConstruct(entt::registry &owner, entt::entity entity)
+{
+    assetManager.addReference(owner.get<component::mesh>(entity).handle);
+}
 
-    auto view = registry.view<component::transform, component::motion>();
+void scene::onMeshDestroy(entt::registry &owner, entt::entity entity)
+{
+    assetManager.releaseReference(owner.get<component::mesh>(entity).handle);
 }
 
 void scene::update(float deltaTime)
@@ -165,84 +268,81 @@ void scene::update(float deltaTime)
 
 void scene::updateTransformMatrices(float dt)
 {
-    using namespace DirectX;
     ZoneScoped;
 
-    auto view = registry.view<component::transform, component::motion>();
-
-    // load dt to all components of vector
-    XMVECTOR dtVec = XMVectorReplicate(dt);
-
-   for ( auto& entity : view)
-    {
-        auto &transform = view.get<component::transform>(entity);
-        auto &motion = view.get<component::motion>(entity);
-
-        XMVECTOR motVelocity = XMLoadFloat4(&motion.velocity);
-        XMVECTOR translation = XMLoadFloat4(&transform.position);
-        XMVECTOR translationResult = XMVectorMultiplyAdd(motVelocity, dtVec, translation);
-        XMStoreFloat4A(&transform.position, translationResult);
-
-        XMVECTOR motRotation = XMLoadFloat4(&motion.rotation);
-        XMVECTOR rotation = XMLoadFloat4(&transform.rotation);
-        XMVECTOR rotationResult = XMVectorMultiplyAdd(motRotation, dtVec, rotation);
-        XMStoreFloat4A(&transform.rotation, rotationResult);
-
-        XMVECTOR scale = XMLoadFloat4(&transform.scale);
-
-        // Not necessary to use translation matrix, just set last row to translation vector
-        // XMMATRIX translationMatrix = XMMatrixTranslationFromVector(translationResult);
-        XMMATRIX rotationMatrix = XMMatrixRotationRollPitchYawFromVector(rotationResult);        
-        
-        XMMATRIX scaleMatrix = XMMatrixScalingFromVector(scale);
-        
-        // XMMATRIX result = XMMatrixMultiply(XMMatrixMultiply(rotationMatrix, scaleMatrix), translationMatrix);
-        // It is faster to just set last row to translation vector
-        XMMATRIX result = XMMatrixMultiply(rotationMatrix, scaleMatrix);
-        result.r[3] = translationResult;
-        result.r[3].m128_f32[3] = 1.0f;
-
-        XMStoreFloat4x4A(reinterpret_cast<XMFLOAT4X4A *>(&hostTransformMatrixBuffer[static_cast<uint32_t>(entity)]), result);
-    }
+    transformPool.integrate(*jobSystem, dt, hostTransformMatrixBuffer.data());
 }
 
+/**
+ * \brief Group entities by mesh and build transform pool and draw data in draw order.
+ *
+ * Entities sharing a mesh get consecutive transform slots, so each group is drawn with one instanced draw where
+ * instance i reads matrix firstInstance + i. Groups are ordered by index type, so the renderer binds each index
+ * buffer once and culled draws of one index type land in one range of the indirect buffer.
+ */
 void scene::prepareFrameData()
 {
     ZoneScoped;
     auto view = registry.view<component::mesh, component::name>();
 
-    uint32_t totVertices = 0;
-    uint32_t totIndices = 0;
-
+    MeshRegistry &meshRegistry = assetManager.getMeshRegistry();
+    std::vector<std::vector<entt::entity>> meshGroups(meshRegistry.size());
     size_t totEntities = {0};
 
     for (auto entity : view)
     {
-        auto &mesh = view.get<component::mesh>(entity);
-        totVertices += mesh.nVertices;
-        totIndices += mesh.nIndices;
+        meshGroups[view.get<component::mesh>(entity).handle].push_back(entity);
         totEntities++;
     }
 
     hostTransformMatrixBuffer.resize(totEntities);
-    hostVertexBuffer.reserve(totVertices);
-    hostVertexNormalBuffer.reserve(totVertices);
-    hostIndexBuffer.reserve(totIndices);
+    hostObjectCullBuffer.reserve(totEntities);
 
-    for (auto entity : view)
+    std::vector<entt::entity> drawOrder;
+    drawOrder.reserve(totEntities);
+
+    for (IndexType indexType : {IndexType::Uint16, IndexType::Uint32})
     {
-        auto &mesh = view.get<component::mesh>(entity);
+        for (MeshHandle handle = 0; handle < meshGroups.size(); handle++)
+        {
+            const MeshInfo &mesh = meshRegistry.get(handle);
+            if (meshGroups[handle].empty() || mesh.indexType != indexType)
+                continue;
+
+            drawGroups.push_back({
+                .indexCount = mesh.indexCount,
+                .firstIndex = mesh.firstIndex,
+                .vertexOffset = mesh.vertexOffset,
+                .firstInstance = static_cast<uint32_t>(drawOrder.size()),
+                .instanceCount = static_cast<uint32_t>(meshGroups[handle].size()),
+                .indexType = indexType,
+            });
+
+            for (auto entity : meshGroups[handle])
+            {
+                hostObjectCullBuffer.push_back({
+                    .boundingSphere = mesh.boundingSphere,
+                    .indexCount = mesh.indexCount,
+                    .firstIndex = mesh.firstIndex,
+                    .vertexOffset = mesh.vertexOffset,
+                    .transformIndex = static_cast<uint32_t>(drawOrder.size()),
+                });
+
+                drawOrder.push_back(entity);
+            }
+        }
+    }
 
-        vertexBufferOffsets.emplace_back(static_cast<uint32_t>(hostVertexBuffer.size()));
-        indexBufferOffsets.emplace_back(static_cast<uint32_t>(hostIndexBuffer.size()));
+    // Matrix of n-th drawn instance is read by n-th instance of the draws
+    transformPool.build(registry, drawOrder);
+    SPDLOG_INFO("[Scene] Transform pool: {} entities, {} kernel", transformPool.size(),
+                transformKernels::getName(transformPool.getKernel()));
 
-        hostVertexBuffer.insert(hostVertexBuffer.end(), mesh.vertices.begin(), mesh.vertices.end());
-        hostVertexNormalBuffer.insert(hostVertexNormalBuffer.end(), mesh.normals.begin(), mesh.normals.end());
-        hostIndexBuffer.insert(hostIndexBuffer.end(), mesh.indices.begin(), mesh.indices.end());
-    }
     SPDLOG_TRACE("[Scene] Frame data prepared");
-    SPDLOG_INFO("[Scene] Total in vectors: totV={}, totN={}, totI={}", hostVertexBuffer.size(), hostVertexNormalBuffer.size(),
-                hostIndexBuffer.size());
+    SPDLOG_INFO("[Scene] Unique meshes: {}, draw groups: {}", meshRegistry.size(), drawGroups.size());
+    SPDLOG_INFO("[Scene] Total in vectors: totV={}, totN={}, totI16={}, totI32={}", meshRegistry.getVertexLump().size(),
+                meshRegistry.getNormalLump().size(), meshRegistry.getIndexLump16().size(), meshRegistry.getIndexLump32().size());
+    assetManager.logMemoryReport();
 }
 
 void scene::updateUniformBuffer()
@@ -260,30 +360,53 @@ void scene::updateUniformBuffer()
 
 std::vector<glm::vec3> &scene::getVertexLump()
 {
-    return hostVertexBuffer;
+    return assetManager.getMeshRegistry().getVertexLump();
 }
 
 std::vector<glm::vec3> &scene::getNormalLump()
 {
-    return hostVertexNormalBuffer;
+    return assetManager.getMeshRegistry().getNormalLump();
 }
 
-std::vector<glm::u16> &scene::getIndexLump()
+std::vector<glm::u16> &scene::getIndexLump16()
 {
-    return hostIndexBuffer;
+    return assetManager.getMeshRegistry().getIndexLump16();
 }
 
-std::vector<glm::uint32_t> &scene::getVertexOffsets()
+std::vector<glm::u32> &scene::getIndexLump32()
 {
-    return vertexBufferOffsets;
+    return assetManager.getMeshRegistry().getIndexLump32();
 }
 
-std::vector<glm::uint32_t> &scene::getIndexOffsets()
+std::vector<MeshDrawGroup> &scene::getDrawGroups()
 {
-    return indexBufferOffsets;
+    return drawGroups;
 }
 
 std::vector<DirectX::XMMATRIX> &scene::getTransformMatricesLump()
 {
     return hostTransformMatrixBuffer;
 }
+
+std::vector<ObjectCullData> &scene::getObjectCullLump()
+{
+    return hostObjectCullBuffer;
+}
+
+const std::vector<DirtyRange> &scene::getDirtyTransformRanges() const
+{
+    return transformPool.getDirtyRanges();
+}
+
+/**
+ * \brief Leave moving transforms to the renderer, which integrates them from getMotionStates() on the GPU.
+ */
+void scene::setGpuTransformIntegration(bool enabled)
+{
+    transformPool.setGpuIntegration(enabled);
+}
+
+std::vector<MotionState> scene::getMotionStates()
+{
+    return transformPool.getMotionStates();
+}
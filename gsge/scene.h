@@ -6,13 +6,6 @@
 
 #include <entt/entity/registry.hpp>
 
-#pragma warning(push)
-#pragma warning(disable : 26451)
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h> // Post processing flags
-#include <assimp/scene.h>       // Output data structure
-#pragma warning(pop)
-
 #pragma warning(suppress : 4275 6285 26498 26451 26800)
 #include <spdlog/spdlog.h>
 
@@ -25,14 +18,22 @@
 #include "component/material.h"
 #include "types.h"
 #include "timer.h"
+#include "core/jobSystem.h"
+#include "core/transformPool.h"
+#include "core/assetManager.h"
+#include <enums.h>
 
 class scene
 {
   public:
-    scene(){};
+    scene(std::shared_ptr<JobSystem> &jobSystem) : jobSystem(jobSystem){};
 
     void initScene();
+    void initBenchScene(uint32_t entityCount, uint32_t uniqueMeshCount, float motionFraction,
+                        ESettings::CameraPath cameraPath);
+    void updateBenchCamera(float time); //!< Place camera on the path of the bench scene, time in seconds from the start
     void loadModel(entt::entity entity, std::string fileName, uint32_t meshId = 0);
+    void waitForModels();
     void update(float deltaTime);
     void updateTransformMatrices(float dt);
     void prepareFrameData();
@@ -40,16 +41,25 @@ class scene
 
     std::vector<glm::vec3> &getVertexLump();
     std::vector<glm::vec3> &getNormalLump();
-    std::vector<glm::u16> &getIndexLump();
-    std::vector<uint32_t> &getVertexOffsets();
-    std::vector<uint32_t> &getIndexOffsets();
+    std::vector<glm::u16> &getIndexLump16();
+    std::vector<glm::u32> &getIndexLump32();
+    std::vector<MeshDrawGroup> &getDrawGroups();
     std::vector<DirectX::XMMATRIX> &getTransformMatricesLump();
+    std::vector<ObjectCullData> &getObjectCullLump();
+    const std::vector<DirtyRange> &getDirtyTransformRanges() const;
+    void setGpuTransformIntegration(bool enabled);
+    std::vector<MotionState> getMotionStates();
 
     UniformBufferObject ubo;
 
     camera mainCamera;
 
   private:
+    std::shared_ptr<JobSystem> jobSystem;
+    TransformPool transformPool;
+    AssetManager assetManager;
+    std::vector<std::pair<entt::entity, std::shared_future<component::mesh>>> pendingModels; // Requested by loadModel()
+
     entt::registry registry;
     entt::entity suzanne, suzanne_smooth, icoSphere, testCube, companionCube, squareFloor, simpleCube, plane, lightGizmo;
 
@@ -58,10 +68,15 @@ class scene
 
     std::vector<uint32_t> objects;
 
-    std::vector<uint32_t> vertexBufferOffsets;
-    std::vector<uint32_t> indexBufferOffsets;
-    std::vector<glm::vec3> hostVertexBuffer;
-    std::vector<glm::vec3> hostVertexNormalBuffer;
-    std::vector<glm::u16> hostIndexBuffer;
+    // Bench scene grid bounds and camera path, see initBenchScene()
+    ESettings::CameraPath benchCameraPath{ESettings::CameraPath::Static};
+    glm::vec3 benchSceneCenter{0.0f};
+    float benchSceneExtent{0.0f}; // Edge length of the grid
+
+    std::vector<MeshDrawGroup> drawGroups; // One instanced draw per mesh used by any entity
+
+    void onMeshConstruct(entt::registry &owner, entt::entity entity);
+    void onMeshDestroy(entt::registry &owner, entt::entity entity);
     std::vector<DirectX::XMMATRIX> hostTransformMatrixBuffer; // TODO: change model to normal matrix in future
+    std::vector<ObjectCullData> hostObjectCullBuffer;         // Bounds and draw arguments, indexed like transform matrices
 };
\ No newline at end of file
@@ -25,7 +25,8 @@ layout(binding = 0) uniform UniformBufferObject {
 
 void main() { 
     
-    mat4 inTransform = objectBuffer.objects[gl_BaseInstance];
+    // gl_InstanceIndex starts at firstInstance of the draw, instances of a mesh have consecutive matrices
+    mat4 inTransform = objectBuffer.objects[gl_InstanceIndex];
 
     fragPosition_WorldSpace = vec3(inTransform * vec4( inPosition, 1.0 ));
     fragNormal_WorldSpace = mat3(inverse(transpose(inTransform))) * inNormal;       
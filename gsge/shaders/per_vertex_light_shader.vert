@@ -1,4 +1,9 @@
-#version 450
+#version 460
+
+layout(std140, set=0, binding = 1) readonly buffer ObjectBuffer
+{
+    mat4 objects[];
+} objectBuffer;
 
 layout(binding = 0) uniform UniformBufferObject {
     mat4 model;
@@ -6,9 +11,10 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 proj;
     mat4 normal;
     vec3 lightPosition;
+    vec3 viewPosition;
 } ubo;
 
-layout(location = 0) in vec3 inPosition;    
+layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 
 layout(location = 0) out vec3 fragColor;
@@ -20,10 +26,14 @@ const float ambientLightPower = 0.025;
 
 void main() {
 
-    vec3 directionToLight = normalize( ubo.lightPosition - inPosition );   
-    vec3 normalWorldSpace = normalize( mat3(ubo.normal) * inNormal );    
+    // gl_InstanceIndex starts at firstInstance of the draw, instances of a mesh have consecutive matrices
+    mat4 inTransform = objectBuffer.objects[gl_InstanceIndex];
+
+    vec3 positionWorldSpace = vec3(inTransform * vec4( inPosition, 1.0 ));
+    vec3 directionToLight = normalize( ubo.lightPosition - positionWorldSpace );
+    vec3 normalWorldSpace = normalize( mat3(inverse(transpose(inTransform))) * inNormal );
     float lightIntensity = ambientLightPower + max( dot( normalWorldSpace, directionToLight ),0 );
-        
-    gl_Position = ubo.proj * ubo.view * ubo.normal * vec4( inPosition, 1.0 );
-    fragColor = materialDiffuseColor * lightIntensity * lightColor;        
+
+    gl_Position = ubo.proj * ubo.view * vec4( positionWorldSpace, 1.0 );
+    fragColor = materialDiffuseColor * lightIntensity * lightColor;
 }
\ No newline at end of file
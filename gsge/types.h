@@ -1,7 +1,23 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 #include <glm/glm.hpp>
 
+// Index of a mesh in MeshRegistry
+using MeshHandle = uint32_t;
+inline constexpr MeshHandle invalidMeshHandle = UINT32_MAX;
+
+// Width of mesh indices. Meshes with up to 65536 vertices use 16-bit indices, every width has its own index lump
+// and index buffer
+enum class IndexType : uint32_t
+{
+    Uint16,
+    Uint32,
+    Count
+};
+
 struct UniformBufferObject
 {
     alignas(16) glm::mat4 model{1.0f};
@@ -11,3 +27,91 @@ struct UniformBufferObject
     alignas(16) glm::vec3 lightPos{glm::vec3(12, -2.2, -2)};
     alignas(16) glm::vec3 viewPos{glm::vec3(0, 0, 0)};
 };
+
+// Per-object data read by the culling compute shader (shaders/cull.comp), std430 layout
+struct ObjectCullData
+{
+    glm::vec4 boundingSphere; // xyz - center in model space, w - radius
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t transformIndex; // Index of the transform matrix, passed to the draw as firstInstance
+};
+
+// Instanced draw of all entities sharing a mesh. Their transform matrices are consecutive, instance i reads matrix
+// firstInstance + i (gl_InstanceIndex)
+struct MeshDrawGroup
+{
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+    IndexType indexType; // Selects the index buffer, firstIndex points into it
+};
+
+// Push constants of the culling compute shader
+struct CullParameters
+{
+    glm::vec4 frustumPlanes[6]; // xyz - normal pointing inside, w - distance, normalized
+    uint32_t objectCount;
+    uint32_t firstUint32Object; // Objects are sorted by index type, objects from here on use 32-bit indices
+};
+
+// Simulation state of a dynamic transform integrated on the GPU (shaders/integrate.comp), std430 layout
+struct MotionState
+{
+    glm::vec3 position;
+    uint32_t transformIndex; // Matrix written by the integration, the transform pool slot of the state
+    glm::vec3 rotation;      // x = pitch, y = yaw, z = roll
+    float padding0;
+    glm::vec3 scale;
+    float padding1;
+    glm::vec3 velocity;
+    float padding2;
+    glm::vec3 angularVelocity;
+    float padding3;
+};
+
+// Push constants of the integration compute shader
+struct IntegrateParameters
+{
+    float dt;
+    uint32_t stateCount;
+};
+
+// Range of consecutive transform slots (and matrices) changed since the last upload
+struct DirtyRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+// Passes measured by GPU timestamp queries every frame, see GpuProfiler
+enum class GpuScope : uint32_t
+{
+    Frame,          // Whole graphics command buffer
+    TransformCopy,  // Staged transform matrices copy on the transfer queue
+    Cull,           // GPU-driven culling compute pass
+    RenderPass,     // Render pass with all draws
+    PresentBarrier, // Transition of the swapchain image for presentation, dynamic rendering only
+    Count
+};
+
+inline const char *getName(GpuScope scope)
+{
+    constexpr const char *names[] = {"frame", "transform copy", "cull", "render pass", "present barrier"};
+    return names[static_cast<size_t>(scope)];
+}
+
+// GPU times of a retired frame in seconds, negative for scopes the frame did not record
+struct GpuFrameTimes
+{
+    uint64_t frameNumber; // Counts submitted frames from 0
+    std::array<float, static_cast<size_t>(GpuScope::Count)> scopes;
+
+    float get(GpuScope scope) const
+    {
+        return scopes[static_cast<size_t>(scope)];
+    }
+};
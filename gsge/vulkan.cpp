@@ -1,13 +1,37 @@
 #include "vulkan.h"
 
+// The only translation unit compiling the stb_image_write implementation
+#pragma warning(push)
+#pragma warning(disable : 4996)
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#pragma warning(pop)
+
 void vulkan::init()
 {
+    headless = settings.Headless.enabled;
+
     instance = std::make_shared<Instance>();
-    surface = std::make_shared<Surface>(instance, window);
+    if (!headless)
+        surface = std::make_shared<Surface>(instance, window);
     device = std::make_shared<Device>(instance, surface);
-    swapchain = std::make_shared<Swapchain>(device, window, surface);
-    renderPass = std::make_shared<RenderPass>(device, swapchain);
-    framebuffer = std::make_shared<Framebuffer>(device, swapchain, renderPass);
+    createSwapchain();
+
+    gpuDrivenSupported = device->getEnabledVulkan12Features().drawIndirectCount == VK_TRUE;
+    if (settings.Renderer.gpuDriven && !gpuDrivenSupported)
+        SPDLOG_WARN("[Renderer] drawIndirectCount is not supported, using instanced draw call per mesh");
+
+    dynamicRenderingSupported = device->getEnabledVulkan13Features().dynamicRendering == VK_TRUE;
+    if (settings.Renderer.dynamicRendering && !dynamicRenderingSupported)
+        SPDLOG_WARN("[Renderer] dynamicRendering is not supported, using render pass and framebuffers");
+
+    dynamicRendering = settings.Renderer.dynamicRendering && dynamicRenderingSupported;
+    createRenderTargets();
+
+    // Known before frame resources are created, transform matrices buffers are then shared with the compute queue
+    gpuTransforms = settings.Renderer.gpuTransforms && !motionStates.empty();
+    if (gpuTransforms)
+        SPDLOG_INFO("[Renderer] {} moving transforms integrated on the compute queue", motionStates.size());
 
     // 1. Create vertex binding descriptors for vertex stage buffers
     createVertexBindingDescriptors();
@@ -15,68 +39,62 @@ void vulkan::init()
     // 2. Create descriptor set layouts (to bind descriptor sets later on)
     createDescriptorSetLayouts();
 
-    // 3. pass (2) as parameter to create pipeline layout and (1) to bind vertex buffers to pipeline
-    createGraphicsPipeline();
+    // 3. pass (2) as parameter to create pipeline layout and (1) to bind vertex buffers to pipelines
+    pipelineCache = std::make_unique<PipelineCache>(device);
+    createPipelineManager();
+    createCullPipeline();
+    if (gpuTransforms)
+        createIntegratePipeline();
+    pipelineCache->save();
 
-    graphicsCommandPool = std::make_unique<CommandPool>(device, device->getGraphicsQueueFamilyIdx(), "Graphics command pool");
-    transferCommandPool = std::make_unique<CommandPool>(device, device->getTransferQueueFamilyIdx(), "Transfer command pool");
-    presentCommandPool = std::make_unique<CommandPool>(device, device->getPresentQueueFamilyIdx(), "Present command pool");
-
-    // 4. create descriptor pool
-    createDescriptorPool();
+    // 4. create resources of every frame in flight, static buffers are uploaded through them
+    createFrameResources();
 
     // 5. create buffers for descriptor sets data
-    createSyncObjects();
-    createTransferCommandBuffers();
     createVertexBuffer();
-    createIndexBuffer();
+    createIndexBuffers();
     createVertexNormalsBuffer();
-    createTransformMatricesBuffer();
-    createUniformBuffers();
+    createCullBuffers();
+    if (gpuTransforms)
+        createMotionStateBuffer();
 
-    // 6. create actual descriptor sets - after buffer creation
+    // 6. create descriptor pool and actual descriptor sets - after buffer creation
+    createDescriptorPool();
     createDescriptorSets();
-
-    createGraphicsCommandBuffers();
-    createPresentCommandBuffers();
 }
 
 vulkan::~vulkan()
 {
     vkDeviceWaitIdle(*device);
 
-    // destroy uniform buffers
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        vkUnmapMemory(*device, transformMatricesStagingBufferMemory[i]);
-
-        vkDestroyBuffer(*device, uniformBuffers[i], nullptr);
-        vkFreeMemory(*device, uniformBuffersMemory[i], nullptr);
-
-        vkDestroyBuffer(*device, transformMatricesBuffer[i], nullptr);
-        vkFreeMemory(*device, transformMatricesBufferMemory[i], nullptr);
-
-        vkDestroyBuffer(*device, transformMatricesStagingBuffer[i], nullptr);
-        vkFreeMemory(*device, transformMatricesStagingBufferMemory[i], nullptr);
-    }
+    destroyFrameResources();
 
     vkDestroyDescriptorPool(*device, descriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(*device, descriptorSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(*device, cullDescriptorSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(*device, integrateDescriptorSetLayout, nullptr);
 
-    vkDestroyBuffer(*device, vertexBuffer, nullptr);
-    vkFreeMemory(*device, vertexBufferMemory, nullptr);
+    vmaDestroyBuffer(device->getAllocator(), objectCullBuffer, objectCullBufferAllocation);
+    if (motionStateBuffer != VK_NULL_HANDLE)
+        vmaDestroyBuffer(device->getAllocator(), motionStateBuffer, motionStateBufferAllocation);
+    vmaDestroyBuffer(device->getAllocator(), vertexBuffer, vertexBufferAllocation);
 
-    vkDestroyBuffer(*device, indexBuffer, nullptr);
-    vkFreeMemory(*device, indexBufferMemory, nullptr);
+    for (size_t i = 0; i < indexBuffers.size(); ++i)
+        vmaDestroyBuffer(device->getAllocator(), indexBuffers[i], indexBuffersAllocation[i]);
 
-    vkDestroyBuffer(*device, vertexNormalsBuffer, nullptr);
-    vkFreeMemory(*device, vertexNormalsBufferMemory, nullptr);
+    vmaDestroyBuffer(device->getAllocator(), vertexNormalsBuffer, vertexNormalsBufferAllocation);
 
-    vkDestroyPipeline(*device, graphicsPipeline, nullptr);
+    // Waits for permutations still being built in the background
+    pipelineManager.reset();
     vkDestroyPipelineLayout(*device, pipelineLayout, nullptr);
 
-    destroySyncObjects();
-    destroyCommandPools();
+    vkDestroyPipeline(*device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(*device, cullPipelineLayout, nullptr);
+    vkDestroyPipeline(*device, integratePipeline, nullptr);
+    vkDestroyPipelineLayout(*device, integratePipelineLayout, nullptr);
+
+    // Saves pipelines compiled since init, e.g. permutations built in the background
+    pipelineCache.reset();
 }
 
 void vulkan::update()
@@ -93,51 +111,66 @@ void vulkan::update()
         isResizing = false;
     }
     
-    // Wait for the current frame to be finished
-    GSGE_CHECK_RESULT(vkWaitForFences(*device, 1, &drawingFinishedFences[currentFrame], VK_TRUE, UINT64_MAX));
-    // Reset a fence indicating that drawing has been finished
-    GSGE_CHECK_RESULT(vkResetFences(*device, 1, &drawingFinishedFences[currentFrame]));
-    
+    frameCpuTimes = {};
+    phaseTimer.resetTimer();
+
+    // Wait for the previous use of the current frame's resources to be finished
+    graphicsTimeline->wait(frameGraphicsValues[currentFrame]);
+    // GPU is done with the frame, so are its uploads, command buffers and timestamp queries
+    uploadRing->beginFrame(currentFrame);
+    resetFrameCommandPools();
+    gpuProfiler->beginFrame(currentFrame);
+    frameCpuTimes.wait = phaseTimer.resetTimer();
+
     acquireNextImage();
+    frameCpuTimes.present = phaseTimer.resetTimer();
     if (isResizing)
         return;
 
     FrameMark;
     updateTransformMatrixBuffer(currentFrame);
+    integrateTransforms();
     updateUniformBuffer(currentFrame);    
+    frameCpuTimes.upload = phaseTimer.resetTimer();
 
     drawFrame();
 }
 
 void vulkan::loadShaders()
 {
-    /*const std::string vertShaderFilename = "shaders/per_vertex_light_shader.vert.spv";
-    const std::string fragShaderFilename = "shaders/per_vertex_light_shader.frag.spv";*/
-
-    const std::string vertShaderFilename = "shaders/per_fragment_light_shader.vert.spv";
-    const std::string fragShaderFilename = "shaders/per_fragment_light_shader.frag.spv";
+    // Graphics shader sets in ShaderSet order, the pipeline manager owns their modules
+    constexpr std::array<const char *, static_cast<size_t>(ShaderSet::Count)> shaderSetFiles = {
+        "shaders/per_fragment_light_shader",
+        "shaders/per_vertex_light_shader",
+    };
 
-    std::ifstream vertShaderFile(vertShaderFilename, std::ios::ate | std::ios::binary);
-    if (!vertShaderFile.is_open())
+    for (size_t i = 0; i < shaderSetFiles.size(); ++i)
     {
-        throw std::runtime_error("failed to open vertex shader!");
+        const std::string fileName = shaderSetFiles[i];
+        pipelineManager->setShaderSet(static_cast<ShaderSet>(i), createShaderModule(readShaderFile(fileName + ".vert.spv")),
+                                      createShaderModule(readShaderFile(fileName + ".frag.spv")));
     }
-    size_t fileSize = static_cast<size_t>(vertShaderFile.tellg());
-    vertShaderCode.resize(fileSize);
-    vertShaderFile.seekg(0);
-    vertShaderFile.read(vertShaderCode.data(), fileSize);
-    vertShaderFile.close();
-
-    std::ifstream fragShaderFile(fragShaderFilename, std::ios::ate | std::ios::binary);
-    if (!fragShaderFile.is_open())
+
+    cullShaderCode = readShaderFile("shaders/cull.comp.spv");
+    if (gpuTransforms)
+        integrateShaderCode = readShaderFile("shaders/integrate.comp.spv");
+}
+
+std::vector<char> vulkan::readShaderFile(const std::string &fileName)
+{
+    std::ifstream shaderFile(fileName, std::ios::ate | std::ios::binary);
+    if (!shaderFile.is_open())
     {
-        throw std::runtime_error("failed to open fragment shader!");
+        throw std::runtime_error("failed to open shader " + fileName + "!");
     }
-    fileSize = static_cast<size_t>(fragShaderFile.tellg());
-    fragShaderCode.resize(fileSize);
-    fragShaderFile.seekg(0);
-    fragShaderFile.read(fragShaderCode.data(), fileSize);
-    fragShaderFile.close();
+
+    size_t fileSize = static_cast<size_t>(shaderFile.tellg());
+    std::vector<char> code(fileSize);
+    shaderFile.seekg(0);
+    shaderFile.read(code.data(), fileSize);
+    shaderFile.close();
+
+    return code;
 }
 
 VkShaderModule vulkan::createShaderModule(const std::vector<char> &code)
@@ -155,214 +188,274 @@ VkShaderModule vulkan::createShaderModule(const std::vector<char> &code)
 }
 
 /**
- * @brief Destroy command pools for graphics and transfer queues.
+ * \brief Create the pipeline layout shared by graphics pipelines and the manager building them.
  *
- * @details Frees command buffers allocated by the pools as well.
- * */
-void vulkan::destroyCommandPools()
+ * The permutation of the current settings is built right away, the other shader sets are built in the background,
+ * so switching to them later does not wait for compilation.
+ */
+void vulkan::createPipelineManager()
 {
-    graphicsCommandPool.reset();
-    transferCommandPool.reset();
-}
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &descriptorSetLayout,
+        .pushConstantRangeCount = 0,
+        .pPushConstantRanges = nullptr,
+    };
 
-void vulkan::createGraphicsPipeline()
-{
+    GSGE_CHECK_RESULT(vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+
+    pipelineManager = std::make_unique<PipelineManager>(device, jobSystem, *pipelineCache, pipelineLayout);
     loadShaders();
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    pipelineManager->setVertexLayout(VertexLayout::PositionNormal, vertexBindingDesc, vertexAttrDesc);
+    pipelineManager->setRenderPass(renderPass);
 
-    // create shader stages
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_VERTEX_BIT,
-        .module = vertShaderModule,
-        .pName = "main",
-    };
+    graphicsPipelineKey = getGraphicsPipelineKey();
+    graphicsPipeline = pipelineManager->getBlocking(graphicsPipelineKey);
 
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-        .module = fragShaderModule,
-        .pName = "main",
-    };
+    for (uint32_t i = 0; i < static_cast<uint32_t>(ShaderSet::Count); ++i)
+    {
+        GraphicsPipelineKey key = graphicsPipelineKey;
+        key.shaderSet = static_cast<ShaderSet>(i);
+        pipelineManager->get(key);
+    }
 
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+    SPDLOG_INFO("[Renderer] Graphics pipelines {}",
+                pipelineManager->isUsingLibraries() ? "linked from pipeline libraries" : "compiled as a whole");
+}
 
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = static_cast<uint32_t>(vertexBindingDesc.size()),
-        .pVertexBindingDescriptions = vertexBindingDesc.data(),
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttrDesc.size()),
-        .pVertexAttributeDescriptions = vertexAttrDesc.data(),
+/**
+ * \brief Key of the graphics pipeline permutation matching current settings and render targets.
+ */
+GraphicsPipelineKey vulkan::getGraphicsPipelineKey()
+{
+    return {
+        .shaderSet = settings.Renderer.perVertexLighting ? ShaderSet::PerVertexLight : ShaderSet::PerFragmentLight,
+        .vertexLayout = VertexLayout::PositionNormal,
+        .sampleCount = renderTargets->getSampleCount(),
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .colorFormat = swapchain->getImageFormat(),
+        .dynamicRendering = dynamicRendering,
     };
+}
 
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-        .primitiveRestartEnable = VK_FALSE,
-    };
+/**
+ * \brief Pick the graphics pipeline drawn with this frame.
+ *
+ * A permutation still being built keeps the previous pipeline drawing, unless the previous one renders to different
+ * attachments - after MSAA, rendering mode or swapchain format changes the frame waits for the build. Fast linked
+ * pipelines are swapped for optimized ones here as well.
+ */
+void vulkan::selectGraphicsPipeline()
+{
+    GraphicsPipelineKey key = getGraphicsPipelineKey();
 
-    VkViewport viewport{
-        .x = 0.0f,
-        .y = 0.0f,
-        .width = static_cast<float>(swapchain->getExtent().width),
-        .height = static_cast<float>(swapchain->getExtent().height),
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f,
+    VkPipeline pipeline = pipelineManager->get(key);
+    if (pipeline == VK_NULL_HANDLE && !key.isCompatible(graphicsPipelineKey))
+        pipeline = pipelineManager->getBlocking(key);
+
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+
+    if (key.shaderSet != graphicsPipelineKey.shaderSet)
+        SPDLOG_INFO("[Renderer] Drawing with {}", getName(key.shaderSet));
+
+    graphicsPipeline = pipeline;
+    graphicsPipelineKey = key;
+}
+
+/**
+ * \brief Create compute pipeline culling objects against the view frustum, see shaders/cull.comp.
+ *
+ * Frustum planes and object count are passed as push constants, so the pipeline does not depend on the swapchain.
+ */
+void vulkan::createCullPipeline()
+{
+    VkShaderModule cullShaderModule = createShaderModule(cullShaderCode);
+
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(CullParameters),
     };
 
-    VkRect2D scissor{
-        .offset = {0, 0},
-        .extent = swapchain->getExtent(),
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &cullDescriptorSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
     };
-    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-    VkPipelineDynamicStateCreateInfo dynamicState{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
-        .pDynamicStates = dynamicStates.data(),
+
+    GSGE_CHECK_RESULT(vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &cullPipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage =
+            {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = cullShaderModule,
+                .pName = "main",
+            },
+        .layout = cullPipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
     };
-    VkPipelineViewportStateCreateInfo viewportState{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-        .viewportCount = 1,
-        .pViewports = &viewport,
-        .scissorCount = 1,
-        .pScissors = &scissor,
+
+    timer creationTimer;
+    GSGE_CHECK_RESULT(vkCreateComputePipelines(*device, *pipelineCache, 1, &pipelineInfo, nullptr, &cullPipeline));
+    logPipelineCreation("Cull pipeline", creationTimer.getTimeAsSeconds());
+
+    vkDestroyShaderModule(*device, cullShaderModule, nullptr);
+
+    GSGE_DEBUGGER_SET_OBJECT_NAME(cullPipeline, "Cull pipeline");
+}
+
+/**
+ * \brief Create compute pipeline integrating motion states into transform matrices, see integrateTransforms().
+ *
+ * Time step and state count are passed as push constants. The descriptor set layout is created here as well, it is
+ * only needed with GPU transform integration.
+ */
+void vulkan::createIntegratePipeline()
+{
+    // motion states and transform matrices of the frame
+    std::array<VkDescriptorSetLayoutBinding, 2> integrateSetLayoutBinding{};
+    for (uint32_t i = 0; i < integrateSetLayoutBinding.size(); i++)
+    {
+        integrateSetLayoutBinding[i].binding = i;
+        integrateSetLayoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        integrateSetLayoutBinding[i].descriptorCount = 1;
+        integrateSetLayoutBinding[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        integrateSetLayoutBinding[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo integrateLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(integrateSetLayoutBinding.size()),
+        .pBindings = integrateSetLayoutBinding.data(),
     };
 
-    VkPipelineRasterizationStateCreateInfo rasterizer{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-        .depthClampEnable = VK_FALSE,
-        .rasterizerDiscardEnable = VK_FALSE,
-        .polygonMode = VK_POLYGON_MODE_FILL,
-        .cullMode = VK_CULL_MODE_BACK_BIT,
-        .frontFace = VK_FRONT_FACE_CLOCKWISE,
-        .depthBiasEnable = VK_FALSE,
-        .lineWidth = 1.0f,
-    };
-
-    VkPipelineMultisampleStateCreateInfo multisampling{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-        .rasterizationSamples = settings.Renderer.msaa.enabled ? settings.Renderer.msaa.sampleCount : VK_SAMPLE_COUNT_1_BIT,
-        .sampleShadingEnable = VK_FALSE,
-        .minSampleShading = 1.0f,
-    };
-
-    VkPipelineDepthStencilStateCreateInfo depthStencil{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-        .depthTestEnable = VK_TRUE,
-        .depthWriteEnable = VK_TRUE,
-        .depthCompareOp = VK_COMPARE_OP_LESS,
-        .depthBoundsTestEnable = VK_FALSE,
-        .stencilTestEnable = VK_FALSE,
-        .minDepthBounds = 0.0f, // Optional - to discard fragments lying outside of rang,
-        .maxDepthBounds = 1.0f,
-    };
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{
-        .blendEnable = VK_FALSE,
-        .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
-        .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-        .colorBlendOp = VK_BLEND_OP_ADD,
-        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-        .alphaBlendOp = VK_BLEND_OP_ADD,
-        .colorWriteMask =
-            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-    };
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .logicOpEnable = VK_FALSE,
-        .logicOp = VK_LOGIC_OP_COPY,
-        .attachmentCount = 1,
-        .pAttachments = &colorBlendAttachment,
-        .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f},
+    GSGE_CHECK_RESULT(vkCreateDescriptorSetLayout(*device, &integrateLayoutInfo, nullptr, &integrateDescriptorSetLayout));
+
+    VkShaderModule integrateShaderModule = createShaderModule(integrateShaderCode);
+
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(IntegrateParameters),
     };
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .setLayoutCount = 1,
-        .pSetLayouts = &descriptorSetLayout,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr,
+        .pSetLayouts = &integrateDescriptorSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
     };
 
-    GSGE_CHECK_RESULT(vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &pipelineLayout));
+    GSGE_CHECK_RESULT(vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &integratePipelineLayout));
 
-    VkGraphicsPipelineCreateInfo pipelineInfo{
-        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .stageCount = 2,
-        .pStages = shaderStages,
-        .pVertexInputState = &vertexInputInfo,
-        .pInputAssemblyState = &inputAssembly,
-        .pViewportState = &viewportState,
-        .pRasterizationState = &rasterizer,
-        .pMultisampleState = &multisampling,
-        .pDepthStencilState = &depthStencil,
-        .pColorBlendState = &colorBlending,
-        .pDynamicState = &dynamicState,
-        .layout = pipelineLayout,
-        .renderPass = *renderPass,
-        .subpass = 0,
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage =
+            {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = integrateShaderModule,
+                .pName = "main",
+            },
+        .layout = integratePipelineLayout,
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = -1,
     };
 
-    GSGE_CHECK_RESULT(vkCreateGraphicsPipelines(*device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline));
+    timer creationTimer;
+    GSGE_CHECK_RESULT(vkCreateComputePipelines(*device, *pipelineCache, 1, &pipelineInfo, nullptr, &integratePipeline));
+    logPipelineCreation("Integrate pipeline", creationTimer.getTimeAsSeconds());
 
-    vkDestroyShaderModule(*device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(*device, vertShaderModule, nullptr);
+    vkDestroyShaderModule(*device, integrateShaderModule, nullptr);
 
-    GSGE_DEBUGGER_SET_OBJECT_NAME(graphicsPipeline, "Graphics pipeline");
-    SPDLOG_TRACE("[Graphics pipeline] Created");
+    GSGE_DEBUGGER_SET_OBJECT_NAME(integratePipeline, "Integrate pipeline");
 }
 
-void vulkan::createGraphicsCommandBuffers()
+/**
+ * \brief Log pipeline creation time, a warm cache was loaded from disk and should make creation much faster.
+ */
+void vulkan::logPipelineCreation(const char *name, float seconds)
 {
-    graphicsCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    VkCommandBufferAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = *graphicsCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = static_cast<uint32_t>(graphicsCommandBuffers.size()),
-    };
-
-    GSGE_CHECK_RESULT(vkAllocateCommandBuffers(*device, &allocInfo, graphicsCommandBuffers.data()));
-
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(graphicsCommandBuffers, "Graphics Command Buffer");
-    SPDLOG_TRACE("[Graphics command buffers] Created");
+    SPDLOG_INFO("[{}] Created in {:.2f} ms, {} pipeline cache", name, seconds * 1000.0f,
+                pipelineCache->isWarm() ? "warm" : "cold");
 }
 
-void vulkan::createTransferCommandBuffers()
+/**
+ * \brief Create transient command pools of every frame in flight.
+ *
+ * Graphics, transfer and present pools of a frame are reset together by resetFrameCommandPools(). Parallel recording
+ * gets one secondary pool per recorder and frame, each reset by the job recording into it.
+ */
+void vulkan::createCommandPools()
 {
-    transferCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    VkCommandBufferAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = *transferCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = static_cast<uint32_t>(transferCommandBuffers.size()),
-    };
+    constexpr VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    graphicsCommandPools.resize(framesInFlight);
+    transferCommandPools.resize(framesInFlight);
+    presentCommandPools.resize(framesInFlight);
+    computeCommandPools.resize(framesInFlight);
 
-    GSGE_CHECK_RESULT(vkAllocateCommandBuffers(*device, &allocInfo, transferCommandBuffers.data()));
+    for (size_t i = 0; i < framesInFlight; i++)
+    {
+        graphicsCommandPools[i] =
+            std::make_unique<CommandPool>(device, device->getGraphicsQueueFamilyIdx(), "Graphics command pool", flags);
+        transferCommandPools[i] =
+            std::make_unique<CommandPool>(device, device->getTransferQueueFamilyIdx(), "Transfer command pool", flags);
+        presentCommandPools[i] =
+            std::make_unique<CommandPool>(device, device->getPresentQueueFamilyIdx(), "Present command pool", flags);
+        computeCommandPools[i] =
+            std::make_unique<CommandPool>(device, device->getComputeQueueFamilyIdx(), "Compute command pool", flags);
+    }
+
+    recorderCount = jobSystem->getThreadCount();
+    secondaryCommandPools.resize(framesInFlight * recorderCount);
+    secondaryCommandBuffers.resize(framesInFlight * recorderCount);
+
+    for (size_t i = 0; i < secondaryCommandPools.size(); i++)
+    {
+        secondaryCommandPools[i] =
+            std::make_unique<CommandPool>(device, device->getGraphicsQueueFamilyIdx(), "Secondary command pool", flags);
+    }
 
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(transferCommandBuffers, "Transfer command buffer");
-    SPDLOG_TRACE("[Transfer command buffers] Created");
+    SPDLOG_TRACE("[Command pools] Created for {} frames, {} recorders", framesInFlight, recorderCount);
 }
 
-void vulkan::createPresentCommandBuffers()
+/**
+ * @brief Destroy command pools of every frame in flight, device must be idle.
+ *
+ * @details Frees command buffers allocated by the pools as well.
+ * */
+void vulkan::destroyCommandPools()
 {
-    presentCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    VkCommandBufferAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = *presentCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = static_cast<uint32_t>(presentCommandBuffers.size()),
-    };
+    graphicsCommandPools.clear();
+    transferCommandPools.clear();
+    presentCommandPools.clear();
+    computeCommandPools.clear();
+    secondaryCommandPools.clear();
+}
 
-    GSGE_CHECK_RESULT(vkAllocateCommandBuffers(*device, &allocInfo, presentCommandBuffers.data()));
+/**
+ * \brief Recycle command buffers of the current frame, its graphics, transfer and compute work must have retired.
+ */
+void vulkan::resetFrameCommandPools()
+{
+    transferTimeline->wait(frameTransferValues[currentFrame]);
+    computeTimeline->wait(frameComputeValues[currentFrame]);
 
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(presentCommandBuffers, "Present command buffer");
-    SPDLOG_TRACE("[Present command buffers] Created");
+    graphicsCommandPools[currentFrame]->reset();
+    transferCommandPools[currentFrame]->reset();
+    presentCommandPools[currentFrame]->reset();
+    computeCommandPools[currentFrame]->reset();
 }
 
 void vulkan::recordPresentCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
@@ -392,7 +485,7 @@ void vulkan::recordPresentCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
             .pImageMemoryBarriers = &presentImageAO_MB,
         };
 
-        vkCmdPipelineBarrier2(presentCommandBuffers[currentFrame], &presentImageAOMBdepInfo);
+        vkCmdPipelineBarrier2(commandBuffer, &presentImageAOMBdepInfo);
     }
 
     // End command buffer
@@ -401,6 +494,13 @@ void vulkan::recordPresentCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
 void vulkan::acquireNextImage()
 {
+    // Offscreen image of a frame is free once the frame retires
+    if (headless)
+    {
+        swapchainImageIndex = currentFrame;
+        return;
+    }
+
     VkAcquireNextImageInfoKHR acquireInfo{
         .sType = VK_STRUCTURE_TYPE_ACQUIRE_NEXT_IMAGE_INFO_KHR,
         .pNext = nullptr,
@@ -434,91 +534,69 @@ void vulkan::recordGraphicsCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
     GSGE_DEBUGGER_CMD_BUFFER_LABEL_BEGIN(commandBuffer, "Graphics CB");
 
-    // ---- MEMORY BARRIERS
-    // Buffer memory barrier to acquire ownership of transformation matrices in this queue family
-    VkBufferMemoryBarrier2 transformMatricesBufferMB_AO{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
-        .pNext = VK_NULL_HANDLE,
-        .srcStageMask = 0,
-        .srcAccessMask = 0,
-        .dstStageMask = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
-        .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
-        .srcQueueFamilyIndex = device->getTransferQueueFamilyIdx(),
-        .dstQueueFamilyIndex = device->getGraphicsQueueFamilyIdx(),
-        .buffer = transformMatricesBuffer[currentFrame],
-        .offset = 0,
-        .size = VK_WHOLE_SIZE,
-    };
-
-    VkDependencyInfo depInfo{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &transformMatricesBufferMB_AO,
-    };
-
-    vkCmdPipelineBarrier2(commandBuffer, &depInfo);
+    gpuProfiler->collect(commandBuffer);
+    gpuProfiler->begin(commandBuffer, GpuScope::Frame);
 
-    // Begin render pass
-    std::array<VkClearValue, 3> clearValues{};
-    clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
-    clearValues[1].depthStencil = {1.0f, 0};
-    clearValues[2].color = {0.02f, 0.02f, 0.02f, 1.0f};
+    bool gpuDriven = settings.Renderer.gpuDriven && gpuDrivenSupported && !objectCullData.empty();
+    if (gpuDriven)
+    {
+        GSGE_GPU_ZONE(*gpuProfiler, commandBuffer, GpuScope::Cull, "Cull");
+        recordCullPass(commandBuffer);
+    }
 
-    VkRenderPassBeginInfo renderPassInfo{
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = *renderPass,
-        .framebuffer = (*framebuffer)[imageIndex],
-        .renderArea =
-            {
-                .offset = {0, 0},
-                .extent = swapchain->getExtent(),
-            },
-        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
-        .pClearValues = clearValues.data(),
-    };
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    // Draw groups are recorded in parallel into secondary command buffers, the GPU-driven path has only a few draws
+    bool parallelRecording = settings.Renderer.parallelRecording && !gpuDriven && recorderCount > 1 &&
+                             drawGroups.size() >= 2 * minDrawGroupsPerRecorder;
 
-    // Bind pipeline
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    // Timestamps are written outside of the render pass, a subpass recorded in secondary command buffers allows no
+    // other commands
+    {
+        GSGE_GPU_ZONE(*gpuProfiler, commandBuffer, GpuScope::RenderPass, "Render pass");
+        beginRendering(commandBuffer, imageIndex, parallelRecording);
 
-    // Set viewport
-    VkViewport viewport{
-        .x = 0.0f,
-        .y = 0.0f,
-        .width = static_cast<float>(swapchain->getExtent().width),
-        .height = static_cast<float>(swapchain->getExtent().height),
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f,
-    };
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        // Draw commands
+        if (parallelRecording)
+        {
+            uint32_t recorders = recordSecondaryCommandBuffers(imageIndex);
+            vkCmdExecuteCommands(commandBuffer, recorders, &secondaryCommandBuffers[currentFrame * recorderCount]);
+        }
+        else if (gpuDriven)
+        {
+            recordDrawState(commandBuffer);
 
-    // Set up scissor
-    VkRect2D scissor{
-        .offset = {0, 0},
-        .extent = swapchain->getExtent(),
-    };
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            // Visible objects only, culling pass wrote their commands and count. Commands of each index type have their
+            // own range of the indirect buffer and their own count
+            const uint32_t objectCounts[] = {firstUint32Object,
+                                             static_cast<uint32_t>(objectCullData.size()) - firstUint32Object};
+            const uint32_t firstObjects[] = {0, firstUint32Object};
 
-    // Bind vertex and index buffers
-    std::vector<VkBuffer> vertexBuffers = {vertexBuffer, vertexNormalsBuffer};
-    std::vector<VkDeviceSize> vertexBuffersOffsets = {0, 0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers.data(), vertexBuffersOffsets.data());
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+            for (size_t type = 0; type < static_cast<size_t>(IndexType::Count); ++type)
+            {
+                if (objectCounts[type] == 0)
+                    continue;
+
+                vkCmdBindIndexBuffer(commandBuffer, indexBuffers[type], 0, toVkIndexType(static_cast<IndexType>(type)));
+                vkCmdDrawIndexedIndirectCount(commandBuffer, indirectDrawBuffers[currentFrame],
+                                              firstObjects[type] * sizeof(VkDrawIndexedIndirectCommand),
+                                              drawCountBuffers[currentFrame], type * sizeof(uint32_t), objectCounts[type],
+                                              sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+        else
+        {
+            recordDrawState(commandBuffer);
+            recordDrawGroups(commandBuffer, 0, drawGroups.size());
+        }
 
-    // Bind descriptors (uniform buffers, etc)
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame],
-                            0, nullptr);
+        endRendering(commandBuffer);
+    }
 
-    // Draw commands
-    for (uint32_t i = 0; i < indexOffsets.size(); i++)
+    if (dynamicRendering)
     {
-        uint32_t endingIdx = (i == indexOffsets.size() - 1 ? indices.size() : indexOffsets[(size_t)i + 1]);
-        vkCmdDrawIndexed(commandBuffer, endingIdx - indexOffsets[i], 1, indexOffsets[i], vertexOffsets[i], i);
+        GSGE_GPU_ZONE(*gpuProfiler, commandBuffer, GpuScope::PresentBarrier, "Present barrier");
+        recordPresentBarrier(commandBuffer, imageIndex);
     }
 
-    // End render pass
-    vkCmdEndRenderPass(commandBuffer);
-
     // ---- MEMORY BARRIERS
     // Release ownership of an image and transition image layout for presentation
     // But what happens if QF are equal? No ownership transfer? does ownership apply only to queue family and not queue itself?
@@ -549,68 +627,553 @@ void vulkan::recordGraphicsCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     //    vkCmdPipelineBarrier2(commandBuffer, &depInfo2);
     //}
 
+    gpuProfiler->end(commandBuffer, GpuScope::Frame);
+
     GSGE_DEBUGGER_CMD_BUFFER_LABEL_END(commandBuffer);
 
     // End command buffer
     GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 }
 
-void vulkan::drawFrame()
+/**
+ * \brief Begin the render pass, or with dynamic rendering transition the attachments and begin rendering to them.
+ *
+ * With MSAA the multisample image is rendered to and resolved into the swapchain image, which is not loaded.
+ *
+ * \param secondaryContents Draws are recorded into secondary command buffers executed by the caller
+ */
+void vulkan::beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaryContents)
 {
-    
-    recordGraphicsCommandBuffer(graphicsCommandBuffers[currentFrame], swapchainImageIndex);
-    recordPresentCommandBuffer(presentCommandBuffers[currentFrame], swapchainImageIndex);
+    std::array<VkClearValue, 3> clearValues{};
+    clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
+    clearValues[1].depthStencil = {1.0f, 0};
+    clearValues[2].color = {0.02f, 0.02f, 0.02f, 1.0f};
 
-    // Graphics queue submit info
-    VkCommandBufferSubmitInfo graphicsCommandBufferSubmitInfo{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .commandBuffer = graphicsCommandBuffers[currentFrame],
+    VkRect2D renderArea{
+        .offset = {0, 0},
+        .extent = swapchain->getExtent(),
     };
 
-    // Sempahore to wait on until image acquisition is complete. stageMask defines second synchronization scope
-    // https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#synchronization-semaphores-waiting
-    // The second synchronization scope includes every command submitted in the same batch. In the case of vkQueueSubmit,
-    // the second synchronization scope is limited to operations on the pipeline stages determined by the destination stage mask
-    // specified by the corresponding element of pWaitDstStageMask. In the case of vkQueueSubmit2, the second synchronization
-    // scope is limited to the pipeline stage specified by VkSemaphoreSubmitInfo::stageMask. Also, in the case of either
-    // vkQueueSubmit2 or vkQueueSubmit, the second synchronization scope additionally includes all commands that occur later in
-    // submission order.
-    VkSemaphoreSubmitInfo imageAquiredSemaphoreSubmitInfo{
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = imageAquiredSemaphores[currentFrame],
-        .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-    };
+    if (!dynamicRendering)
+    {
+        VkRenderPassBeginInfo renderPassInfo{
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass = *renderPass,
+            .framebuffer = (*framebuffer)[imageIndex],
+            .renderArea = renderArea,
+            .clearValueCount = static_cast<uint32_t>(clearValues.size()),
+            .pClearValues = clearValues.data(),
+        };
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                             secondaryContents ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
 
-    VkSemaphoreSubmitInfo transferFinishedSemaphoreSubmitInfo{
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = transferFinishedSemaphores[currentFrame],
-        .stageMask = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
-    };
+    bool multisampled = renderTargets->isMultisampled();
+
+    // Same synchronization as the external subpass dependencies of RenderPass. Contents of all attachments are
+    // discarded, the swapchain image waits for the acquire semaphore at color attachment output
+    std::vector<VkImageMemoryBarrier2> barriers;
+    barriers.push_back({
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .srcAccessMask = VK_ACCESS_2_NONE,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .image = swapchain->getImage(imageIndex),
+        .subresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    });
+    barriers.push_back({
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        .srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        .dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .image = renderTargets->getDepthImage(imageIndex),
+        .subresourceRange{VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1},
+    });
+
+    if (multisampled)
+    {
+        barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+            .image = renderTargets->getMultisampleImage(imageIndex),
+            .subresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        });
+    }
 
-    std::array<VkSemaphoreSubmitInfo, 2> waitSemaphoresInfos = {
-        imageAquiredSemaphoreSubmitInfo,
-        transferFinishedSemaphoreSubmitInfo,
+    VkDependencyInfo attachmentsDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+        .pImageMemoryBarriers = barriers.data(),
     };
-
-    VkSemaphoreSubmitInfo renderFinishedSemaphoreSubmitInfo{
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = renderFinishedSemaphores[currentFrame],
-        .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+    vkCmdPipelineBarrier2(commandBuffer, &attachmentsDepInfo);
+
+    VkRenderingAttachmentInfo colorAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = multisampled ? renderTargets->getMultisampleImageView(imageIndex) : swapchain->getImageView(imageIndex),
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .resolveMode = multisampled ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE,
+        .resolveImageView = multisampled ? swapchain->getImageView(imageIndex) : VK_NULL_HANDLE,
+        .resolveImageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
+        .clearValue = multisampled ? clearValues[2] : clearValues[0],
     };
 
-    VkSubmitInfo2 graphicsQueueSubmitInfo{
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-        .pNext = nullptr,
-        .waitSemaphoreInfoCount = static_cast<uint32_t>(waitSemaphoresInfos.size()),
-        .pWaitSemaphoreInfos = waitSemaphoresInfos.data(),
-        .commandBufferInfoCount = 1,
-        .pCommandBufferInfos = &graphicsCommandBufferSubmitInfo,
-        .signalSemaphoreInfoCount = 1,
-        .pSignalSemaphoreInfos = &renderFinishedSemaphoreSubmitInfo,
+    VkRenderingAttachmentInfo depthAttachment{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = renderTargets->getDepthImageView(imageIndex),
+        .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .clearValue = clearValues[1],
     };
 
-    GSGE_CHECK_RESULT(
-        vkQueueSubmit2(device->getGraphicsQueue(), 1, &graphicsQueueSubmitInfo, drawingFinishedFences[currentFrame]));
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .flags = secondaryContents ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : VkRenderingFlags{0},
+        .renderArea = renderArea,
+        .layerCount = 1,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorAttachment,
+        .pDepthAttachment = &depthAttachment,
+    };
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+/**
+ * \brief End the render pass, or end rendering. The render pass transitions the swapchain image itself, with dynamic
+ * rendering recordPresentBarrier() follows.
+ */
+void vulkan::endRendering(VkCommandBuffer commandBuffer)
+{
+    if (dynamicRendering)
+        vkCmdEndRendering(commandBuffer);
+    else
+        vkCmdEndRenderPass(commandBuffer);
+}
+
+/**
+ * \brief Transition the swapchain image rendered with dynamic rendering for presentation (or readback of the offscreen
+ * image in headless mode).
+ */
+void vulkan::recordPresentBarrier(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    // Render finished semaphore is signalled at color attachment output, after the transition
+    VkImageMemoryBarrier2 presentBarrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .dstAccessMask = VK_ACCESS_2_NONE,
+        .oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL,
+        .newLayout = swapchain->getFinalLayout(),
+        .image = swapchain->getImage(imageIndex),
+        .subresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+
+    VkDependencyInfo presentDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &presentBarrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &presentDepInfo);
+}
+
+/**
+ * \brief Record pipeline, dynamic state, vertex buffers and descriptors shared by all draws of the render pass.
+ *
+ * Secondary command buffers inherit none of it from the primary one, so every recorder calls this as well.
+ */
+void vulkan::recordDrawState(VkCommandBuffer commandBuffer)
+{
+    // Bind pipeline
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+
+    // Set viewport
+    VkViewport viewport{
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(swapchain->getExtent().width),
+        .height = static_cast<float>(swapchain->getExtent().height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    // Set up scissor
+    VkRect2D scissor{
+        .offset = {0, 0},
+        .extent = swapchain->getExtent(),
+    };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Bind vertex and index buffers
+    std::vector<VkBuffer> vertexBuffers = {vertexBuffer, vertexNormalsBuffer};
+    std::vector<VkDeviceSize> vertexBuffersOffsets = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers.data(), vertexBuffersOffsets.data());
+
+    // Bind descriptors (uniform buffers, etc)
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame],
+                            1, &uniformBufferOffset);
+}
+
+/**
+ * \brief Record one instanced draw per mesh for draw groups [firstGroup, firstGroup + groupCount).
+ */
+void vulkan::recordDrawGroups(VkCommandBuffer commandBuffer, size_t firstGroup, size_t groupCount)
+{
+    // Instances read consecutive transform matrices. Groups are sorted by index type
+    IndexType boundIndexType = IndexType::Count;
+    for (size_t i = firstGroup; i < firstGroup + groupCount; ++i)
+    {
+        const MeshDrawGroup &group = drawGroups[i];
+
+        if (group.indexType != boundIndexType)
+        {
+            boundIndexType = group.indexType;
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffers[static_cast<size_t>(boundIndexType)], 0,
+                                 toVkIndexType(boundIndexType));
+        }
+
+        vkCmdDrawIndexed(commandBuffer, group.indexCount, group.instanceCount, group.firstIndex, group.vertexOffset,
+                         group.firstInstance);
+    }
+}
+
+/**
+ * \brief Split draw groups between recorders and record their secondary command buffers on the job system.
+ *
+ * Every recorder resets its own pool of the current frame, the graphics timeline wait in update() guarantees the
+ * previous use of the frame's secondary command buffers has finished. Recorders get contiguous ranges, so the
+ * index buffer is rebound at most once per recorder and the draw order of the inline path is kept.
+ *
+ * \return Number of secondary command buffers recorded, starting at currentFrame * recorderCount
+ */
+uint32_t vulkan::recordSecondaryCommandBuffers(uint32_t imageIndex)
+{
+    ZoneScoped;
+
+    size_t groupCount = drawGroups.size();
+    uint32_t recorders = static_cast<uint32_t>(std::min<size_t>(recorderCount, groupCount / minDrawGroupsPerRecorder));
+    size_t groupsPerRecorder = (groupCount + recorders - 1) / recorders;
+    // Rounding groupsPerRecorder up can leave trailing recorders without groups, every recorder starts inside drawGroups
+    recorders = static_cast<uint32_t>((groupCount + groupsPerRecorder - 1) / groupsPerRecorder);
+
+    // Dynamic rendering has no render pass to inherit, secondaries declare the attachment formats instead
+    VkFormat colorFormat = swapchain->getImageFormat();
+    VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat = RenderTargets::depthFormat,
+        .rasterizationSamples = renderTargets->getSampleCount(),
+    };
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = dynamicRendering ? &inheritanceRenderingInfo : nullptr,
+        .renderPass = dynamicRendering ? VK_NULL_HANDLE : static_cast<VkRenderPass>(*renderPass),
+        .subpass = 0,
+        .framebuffer = dynamicRendering ? VK_NULL_HANDLE : (*framebuffer)[imageIndex],
+    };
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo,
+    };
+
+    jobSystem->parallelFor(recorders, 1, [&](size_t begin, size_t end) {
+        for (size_t recorder = begin; recorder < end; ++recorder)
+        {
+            ZoneScopedN("Record secondary CB");
+
+            size_t slot = currentFrame * recorderCount + recorder;
+            size_t firstGroup = recorder * groupsPerRecorder;
+
+            secondaryCommandPools[slot]->reset();
+            VkCommandBuffer commandBuffer = secondaryCommandPools[slot]->acquire(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            secondaryCommandBuffers[slot] = commandBuffer;
+            GSGE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+            recordDrawState(commandBuffer);
+            recordDrawGroups(commandBuffer, firstGroup, std::min(groupsPerRecorder, groupCount - firstGroup));
+
+            GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+        }
+    });
+
+    return recorders;
+}
+
+/**
+ * \brief Record frustum culling of all objects, must be recorded outside of a render pass.
+ *
+ * Resets the draw count, dispatches shaders/cull.comp which appends a draw command for every visible object and makes
+ * the commands visible to the indirect draw.
+ */
+void vulkan::recordCullPass(VkCommandBuffer commandBuffer)
+{
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_BEGIN(commandBuffer, "Culling");
+
+    vkCmdFillBuffer(commandBuffer, drawCountBuffers[currentFrame], 0, sizeof(uint32_t) * static_cast<size_t>(IndexType::Count),
+                    0);
+
+    VkMemoryBarrier2 countResetBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    };
+
+    VkDependencyInfo countResetDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &countResetBarrier,
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &countResetDepInfo);
+
+    CullParameters cullParameters{
+        .objectCount = static_cast<uint32_t>(objectCullData.size()),
+        .firstUint32Object = firstUint32Object,
+    };
+    getFrustumPlanes(cullParameters.frustumPlanes);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1,
+                            &cullDescriptorSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cullParameters), &cullParameters);
+    vkCmdDispatch(commandBuffer, (cullParameters.objectCount + cullWorkgroupSize - 1) / cullWorkgroupSize, 1, 1);
+
+    VkMemoryBarrier2 drawCommandsBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+        .dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+    };
+
+    VkDependencyInfo drawCommandsDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &drawCommandsBarrier,
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &drawCommandsDepInfo);
+
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_END(commandBuffer);
+}
+
+/**
+ * \brief Extract view frustum planes in world space from the projection and view matrices (Gribb-Hartmann).
+ *
+ * Plane normals point inside the frustum and are normalized, so the plane equation gives the signed distance.
+ * Projection matrix maps depth to [-1, 1] (glm default).
+ */
+void vulkan::getFrustumPlanes(glm::vec4 planes[6])
+{
+    glm::mat4 projView = local_ubo.proj * local_ubo.view;
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(projView[0][i], projView[1][i], projView[2][i], projView[3][i]);
+
+    planes[0] = row[3] + row[0]; // left
+    planes[1] = row[3] - row[0]; // right
+    planes[2] = row[3] + row[1]; // bottom
+    planes[3] = row[3] - row[1]; // top
+    planes[4] = row[3] + row[2]; // near
+    planes[5] = row[3] - row[2]; // far
+
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+/**
+ * \brief Integrate motion states of moving transforms on the compute queue and write their matrices for this frame.
+ *
+ * The dispatch runs on the async compute queue while the CPU records the frame, the graphics submit waits for it on
+ * the compute timeline. Matrices staged on the transfer queue in this frame are copied first, the copy may overwrite
+ * moving transforms with stale host matrices when it merges ranges.
+ */
+void vulkan::integrateTransforms()
+{
+    ZoneScoped;
+
+    transformComputeSubmitted = gpuTransforms;
+    if (!gpuTransforms)
+        return;
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    VkCommandBuffer commandBuffer = computeCommandPools[currentFrame]->acquire();
+
+    GSGE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_BEGIN(commandBuffer, "Transform integration");
+
+    // Motion states are advanced in place, the previous frame's dispatch on this queue has to finish writing them
+    VkMemoryBarrier2 motionStateBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    };
+
+    VkDependencyInfo motionStateDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &motionStateBarrier,
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &motionStateDepInfo);
+
+    IntegrateParameters integrateParameters{
+        .dt = integrationStep,
+        .stateCount = static_cast<uint32_t>(motionStates.size()),
+    };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, integratePipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, integratePipelineLayout, 0, 1,
+                            &integrateDescriptorSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, integratePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(integrateParameters),
+                       &integrateParameters);
+    vkCmdDispatch(commandBuffer, (integrateParameters.stateCount + integrateWorkgroupSize - 1) / integrateWorkgroupSize, 1, 1);
+
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_END(commandBuffer);
+    GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+    VkCommandBufferSubmitInfo cbSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = commandBuffer,
+    };
+
+    // Copy of this frame's matrices writes the same buffer
+    VkSemaphoreSubmitInfo transferSemaphoreInfo =
+        transferTimeline->getSubmitInfo(transformTransferValue, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+    transformComputeValue = computeTimeline->next();
+    frameComputeValues[currentFrame] = transformComputeValue;
+    VkSemaphoreSubmitInfo computeSemaphoreInfo =
+        computeTimeline->getSubmitInfo(transformComputeValue, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+    VkSubmitInfo2 submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .waitSemaphoreInfoCount = transformTransferSubmitted ? 1u : 0u,
+        .pWaitSemaphoreInfos = &transferSemaphoreInfo,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &cbSubmitInfo,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &computeSemaphoreInfo,
+    };
+
+    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+}
+
+void vulkan::drawFrame()
+{
+    selectGraphicsPipeline();
+
+    VkCommandBuffer graphicsCommandBuffer = graphicsCommandPools[currentFrame]->acquire();
+    VkCommandBuffer presentCommandBuffer = presentCommandPools[currentFrame]->acquire();
+
+    recordGraphicsCommandBuffer(graphicsCommandBuffer, swapchainImageIndex);
+    recordPresentCommandBuffer(presentCommandBuffer, swapchainImageIndex);
+    frameCpuTimes.record = phaseTimer.resetTimer();
+
+    // Graphics queue submit info
+    VkCommandBufferSubmitInfo graphicsCommandBufferSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = graphicsCommandBuffer,
+    };
+
+    // Sempahore to wait on until image acquisition is complete. stageMask defines second synchronization scope
+    // https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#synchronization-semaphores-waiting
+    // The second synchronization scope includes every command submitted in the same batch. In the case of vkQueueSubmit,
+    // the second synchronization scope is limited to operations on the pipeline stages determined by the destination stage mask
+    // specified by the corresponding element of pWaitDstStageMask. In the case of vkQueueSubmit2, the second synchronization
+    // scope is limited to the pipeline stage specified by VkSemaphoreSubmitInfo::stageMask. Also, in the case of either
+    // vkQueueSubmit2 or vkQueueSubmit, the second synchronization scope additionally includes all commands that occur later in
+    // submission order.
+    VkSemaphoreSubmitInfo imageAquiredSemaphoreSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = imageAquiredSemaphores[currentFrame],
+        .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+    };
+
+    // Culling and vertex shaders read transform matrices copied on the transfer queue
+    VkSemaphoreSubmitInfo transformTransferSubmitInfo = transferTimeline->getSubmitInfo(
+        transformTransferValue, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+
+    std::array<VkSemaphoreSubmitInfo, 3> waitSemaphoresInfos{};
+    uint32_t waitSemaphoreCount = 0;
+
+    // Offscreen images are not acquired
+    if (!headless)
+        waitSemaphoresInfos[waitSemaphoreCount++] = imageAquiredSemaphoreSubmitInfo;
+
+    // Nothing to wait for when no transform matrix changed or matrices are written directly
+    if (transformTransferSubmitted)
+        waitSemaphoresInfos[waitSemaphoreCount++] = transformTransferSubmitInfo;
+
+    // Moving transforms are integrated on the compute queue, see integrateTransforms()
+    if (transformComputeSubmitted)
+        waitSemaphoresInfos[waitSemaphoreCount++] = computeTimeline->getSubmitInfo(
+            transformComputeValue, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+
+    VkSemaphoreSubmitInfo renderFinishedSemaphoreSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = renderFinishedSemaphores[currentFrame],
+        .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+    };
+
+    // Frame's resources are free for reuse once the graphics timeline reaches this value
+    frameGraphicsValues[currentFrame] = graphicsTimeline->next();
+
+    // Render finished semaphore is waited on by the present only
+    std::array<VkSemaphoreSubmitInfo, 2> signalSemaphoresInfos = {
+        graphicsTimeline->getSubmitInfo(frameGraphicsValues[currentFrame], VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT),
+        renderFinishedSemaphoreSubmitInfo,
+    };
+    uint32_t signalSemaphoreCount = headless ? 1 : 2;
+
+    VkSubmitInfo2 graphicsQueueSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .pNext = nullptr,
+        .waitSemaphoreInfoCount = waitSemaphoreCount,
+        .pWaitSemaphoreInfos = waitSemaphoresInfos.data(),
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &graphicsCommandBufferSubmitInfo,
+        .signalSemaphoreInfoCount = signalSemaphoreCount,
+        .pSignalSemaphoreInfos = signalSemaphoresInfos.data(),
+    };
+
+    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getGraphicsQueue(), 1, &graphicsQueueSubmitInfo, VK_NULL_HANDLE));
+    frameCpuTimes.submit = phaseTimer.resetTimer();
+
+    gpuProfiler->endFrame(submittedFrameCount++);
+
+    if (headless)
+    {
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        return;
+    }
 
 
     //// present queue submission
@@ -655,7 +1218,19 @@ void vulkan::drawFrame()
 
     // Presentation of current frame's image after renderFinishedSemaphore[currentFrame] is signalled
     GSGE_CHECK_RESULT(vkQueuePresentKHR(device->getPresentQueue(), &presentInfo));
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    frameCpuTimes.present += phaseTimer.resetTimer();
+    currentFrame = (currentFrame + 1) % framesInFlight;
+}
+
+/**
+ * \brief Create swapchain of the window surface, or offscreen images standing in for it in headless mode.
+ */
+void vulkan::createSwapchain()
+{
+    if (headless)
+        swapchain = std::make_shared<Swapchain>(device);
+    else
+        swapchain = std::make_shared<Swapchain>(device, window, surface);
 }
 
 /**
@@ -665,129 +1240,386 @@ void vulkan::drawFrame()
 void vulkan::handleSurfaceResize()
 {
     GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
-    freeCommandBuffers();
-    destroySyncObjects();
+    destroySwapchainSemaphores();
 
     {
+        destroyRenderTargets();
         swapchain.reset();
-        renderPass.reset();
-        framebuffer.reset();
     }
 
-    swapchain.reset(new Swapchain(device, window, surface));
-    renderPass.reset(new RenderPass(device, swapchain));
-    framebuffer.reset(new Framebuffer(device, swapchain, renderPass));
+    createSwapchain();
+    createRenderTargets();
 
-    createTransferCommandBuffers();
-    createGraphicsCommandBuffers();
-    createSyncObjects();
+    createSwapchainSemaphores();
     swapchainAspectChanged = true;
     GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
 }
 
+void vulkan::logMemoryStats()
+{
+    device->logMemoryStats();
+}
+
+/**
+ * \brief Wait until the device is idle, frames still in flight are retired oldest first.
+ */
+void vulkan::waitIdle()
+{
+    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+
+    gpuProfiler->retireAll();
+}
+
+const std::vector<GpuFrameTimes> &vulkan::getRetiredFrameTimings() const
+{
+    return gpuProfiler->getRetiredFrames();
+}
+
+uint64_t vulkan::getSubmittedFrameCount() const
+{
+    return submittedFrameCount;
+}
+
+const vulkan::FrameCpuTimes &vulkan::getFrameCpuTimes() const
+{
+    return frameCpuTimes;
+}
+
 /**
- * @brief Recreate frame resources when number of samples per pixel changes.
+ * \brief Copy offscreen image of the latest frame into a host visible buffer and write it to a PNG file.
  *
- * When MSAA changes, framebuffer resources need to be recreated as their sample count is declared
- * during creation.
+ * Meant for checks of headless runs, the device is idle on return.
+ */
+void vulkan::saveFrameImage(const std::string &fileName)
+{
+    if (!headless)
+        throw std::runtime_error("[Renderer] Frame images are saved in headless mode only");
+
+    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+
+    const VkExtent2D extent = swapchain->getExtent();
+    const VkImage image = swapchain->getImage(swapchainImageIndex);
+
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = VkDeviceSize{extent.width} * extent.height * 4,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    // Read back by the host, so cached memory is preferred
+    VmaAllocationCreateInfo allocationInfo{
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO,
+    };
+
+    VkBuffer readbackBuffer;
+    VmaAllocation readbackAllocation;
+    VmaAllocationInfo readbackInfo;
+    GSGE_CHECK_RESULT(vmaCreateBuffer(device->getAllocator(), &bufferInfo, &allocationInfo, &readbackBuffer, &readbackAllocation,
+                                      &readbackInfo));
+
+    CommandPool commandPool(device, device->getGraphicsQueueFamilyIdx(), "Readback command pool",
+                            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+    VkCommandBuffer commandBuffer = commandPool.acquire();
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    GSGE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+    // Frame was rendered by an earlier submit to the same queue, the image is already in TRANSFER_SRC_OPTIMAL
+    VkImageMemoryBarrier2 renderedBarrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+        .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .image = image,
+        .subresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+
+    VkDependencyInfo renderedDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &renderedBarrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &renderedDepInfo);
+
+    VkBufferImageCopy region{
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {extent.width, extent.height, 1},
+    };
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+    VkBufferMemoryBarrier2 hostReadBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+        .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+        .buffer = readbackBuffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+
+    VkDependencyInfo hostReadDepInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &hostReadBarrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &hostReadDepInfo);
+
+    GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+    VkCommandBufferSubmitInfo cbSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = commandBuffer,
+    };
+
+    uint64_t readbackValue = graphicsTimeline->next();
+    VkSemaphoreSubmitInfo readbackSemaphoreInfo =
+        graphicsTimeline->getSubmitInfo(readbackValue, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+    VkSubmitInfo2 submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &cbSubmitInfo,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &readbackSemaphoreInfo,
+    };
+
+    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+    graphicsTimeline->wait(readbackValue);
+
+    GSGE_CHECK_RESULT(vmaInvalidateAllocation(device->getAllocator(), readbackAllocation, 0, VK_WHOLE_SIZE));
+
+    // Offscreen images are R8G8B8A8, rows are tightly packed
+    int written = stbi_write_png(fileName.c_str(), static_cast<int>(extent.width), static_cast<int>(extent.height), 4,
+                                 readbackInfo.pMappedData, static_cast<int>(extent.width * 4));
+
+    vmaDestroyBuffer(device->getAllocator(), readbackBuffer, readbackAllocation);
+
+    if (!written)
+        throw std::runtime_error(std::format("[Renderer] Failed to write frame image to {}", fileName));
+
+    SPDLOG_INFO("[Renderer] Frame image {}x{} written to {}", extent.width, extent.height, fileName);
+}
+
+/**
+ * @brief Recreate render targets and switch graphics pipeline when number of samples per pixel changes.
+ *
+ * When MSAA changes, attachment images need to be recreated as their sample count is declared during creation. The
+ * swapchain does not depend on it and is kept, with dynamic rendering the images are all that is recreated. The
+ * pipeline's rasterization sample count is static state, so the permutation of the new sample count is taken from
+ * the pipeline manager, previously used ones are cached.
  */
 void vulkan::handleMSAAChange()
 {
     vkDeviceWaitIdle(*device);
-    freeCommandBuffers();
-    vkDestroyPipeline(*device, graphicsPipeline, nullptr);
-    vkDestroyPipelineLayout(*device, pipelineLayout, nullptr);
+
+    destroyRenderTargets();
+    createRenderTargets();
+
+    selectGraphicsPipeline();
+    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+}
+
+/**
+ * @brief Switch between render pass and dynamic rendering after the setting changed.
+ *
+ * Graphics pipeline is created against the render pass or the attachment formats, so it is switched as well.
+ */
+void vulkan::handleRenderingModeChange()
+{
+    bool requested = settings.Renderer.dynamicRendering && dynamicRenderingSupported;
+    if (settings.Renderer.dynamicRendering && !dynamicRenderingSupported)
+        SPDLOG_WARN("[Renderer] dynamicRendering is not supported, using render pass and framebuffers");
+
+    if (requested == dynamicRendering)
+        return;
+
+    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+
+    destroyRenderTargets();
+    dynamicRendering = requested;
+    createRenderTargets();
+
+    selectGraphicsPipeline();
+    SPDLOG_INFO("[Renderer] {}", dynamicRendering ? "Dynamic rendering" : "Render pass and framebuffers");
+}
+
+/**
+ * @brief Create attachment images of every swapchain image, plus render pass and framebuffers without dynamic rendering.
+ *
+ */
+void vulkan::createRenderTargets()
+{
+    renderTargets = std::make_shared<RenderTargets>(device, swapchain);
+
+    if (!dynamicRendering)
+    {
+        renderPass = std::make_shared<RenderPass>(device, swapchain);
+        framebuffer = std::make_shared<Framebuffer>(device, swapchain, renderPass, renderTargets);
+    }
+
+    // Created in init after the first render targets
+    if (pipelineManager)
+        pipelineManager->setRenderPass(renderPass);
+}
+
+void vulkan::destroyRenderTargets()
+{
+    framebuffer.reset();
+    renderPass.reset();
+    renderTargets.reset();
+}
+
+/**
+ * @brief Rebuild per-frame resources and the swapchain after frames in flight or swapchain image count changed.
+ *
+ * Static buffers and pipelines are kept, descriptor sets are reallocated as there is one per frame in flight.
+ */
+void vulkan::handleFrameSettingsChange()
+{
+    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+
+    // Frames still in flight are reported by the next update() through the new profiler
+    gpuProfiler->retireAll();
+    std::vector<GpuFrameTimes> inFlightFrameTimings = gpuProfiler->getRetiredFrames();
+
+    vkDestroyDescriptorPool(*device, descriptorPool, nullptr);
+    destroyFrameResources();
+
+    {
+        destroyRenderTargets();
+        swapchain.reset();
+    }
+
+    createSwapchain();
+    createRenderTargets();
+
+    createFrameResources();
+    gpuProfiler->carryRetiredFrames(inFlightFrameTimings);
+    createDescriptorPool();
+    createDescriptorSets();
+    swapchainAspectChanged = true;
+}
+
+/**
+ * @brief Create everything sized by the number of frames in flight.
+ *
+ * Sync objects, command buffers, upload ring partitions, transform matrices and indirect draw buffers. Descriptor
+ * sets are per frame as well, but they also point to static buffers, so they are created separately.
+ */
+void vulkan::createFrameResources()
+{
+    framesInFlight = std::max(settings.Renderer.framesInFlight, 1u);
+    currentFrame = 0;
+
+    createSyncObjects();
+    gpuProfiler = std::make_unique<GpuProfiler>(device, framesInFlight);
+    createCommandPools();
+    createUploadRing();
+    createTransformMatricesBuffer();
+    createIndirectDrawBuffers();
+
+    SPDLOG_INFO("[Renderer] {} frames in flight, {} swapchain images", framesInFlight, swapchain->getImageCount());
+}
+
+/**
+ * @brief Destroy everything created by createFrameResources(), device must be idle.
+ *
+ */
+void vulkan::destroyFrameResources()
+{
+    destroyCommandPools();
     destroySyncObjects();
+    gpuProfiler.reset();
+    uploadRing.reset();
 
+    for (size_t i = 0; i < framesInFlight; i++)
     {
-        swapchain.reset();
-        renderPass.reset();
-        framebuffer.reset();
+        vmaDestroyBuffer(device->getAllocator(), transformMatricesBuffer[i], transformMatricesBufferAllocation[i]);
+        vmaDestroyBuffer(device->getAllocator(), indirectDrawBuffers[i], indirectDrawBuffersAllocation[i]);
+        vmaDestroyBuffer(device->getAllocator(), drawCountBuffers[i], drawCountBuffersAllocation[i]);
     }
+}
 
-    swapchain.reset(new Swapchain(device, window, surface));
-    renderPass.reset(new RenderPass(device, swapchain));
-    framebuffer.reset(new Framebuffer(device, swapchain, renderPass));
-
-    createGraphicsPipeline();
-    createTransferCommandBuffers();
-    createGraphicsCommandBuffers();
-    createSyncObjects();
-    GSGE_CHECK_RESULT(vkDeviceWaitIdle(*device));
+/**
+ *  @brief Create timeline semaphores of the queues and the binary semaphores of the swapchain.
+ *
+ */
+void vulkan::createSyncObjects()
+{
+    // Waiting for value 0 of a new timeline returns at once
+    frameGraphicsValues.assign(framesInFlight, 0);
+    frameTransferValues.assign(framesInFlight, 0);
+    frameComputeValues.assign(framesInFlight, 0);
+    transformTransferValue = 0;
+    transformComputeValue = 0;
+
+    graphicsTimeline = std::make_unique<TimelineSemaphore>(device, "Graphics timeline");
+    transferTimeline = std::make_unique<TimelineSemaphore>(device, "Transfer timeline");
+    computeTimeline = std::make_unique<TimelineSemaphore>(device, "Compute timeline");
+
+    createSwapchainSemaphores();
+    SPDLOG_TRACE("[Synchronization objects] Created");
 }
 
 /**
- * @brief Free allocated command buffers.
+ * @brief Destroy syncronization objects.
  *
  */
-void vulkan::freeCommandBuffers()
+void vulkan::destroySyncObjects()
 {
-    vkFreeCommandBuffers(*device, *graphicsCommandPool, static_cast<uint32_t>(graphicsCommandBuffers.size()),
-                         graphicsCommandBuffers.data());
-    vkFreeCommandBuffers(*device, *transferCommandPool, static_cast<uint32_t>(transferCommandBuffers.size()),
-                         transferCommandBuffers.data());
+    destroySwapchainSemaphores();
 
-    SPDLOG_TRACE("[Command buffers] Freed");
+    graphicsTimeline.reset();
+    transferTimeline.reset();
+    computeTimeline.reset();
+
+    SPDLOG_TRACE("[Synchronization objects] Destroyed");
 }
 
 /**
- *  @brief Create semaphores and fences for each frame in flight.
+ * @brief Create binary semaphores for swapchain acquire and present of each frame in flight.
  *
+ * Only these are recreated with the swapchain, timelines and their values outlive a resize.
  */
-void vulkan::createSyncObjects()
+void vulkan::createSwapchainSemaphores()
 {
-    imageAquiredSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    prePresentCompleteSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    transferFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    drawingFinishedFences.resize(MAX_FRAMES_IN_FLIGHT);
-    transferFinishedFences.resize(MAX_FRAMES_IN_FLIGHT);
+    imageAquiredSemaphores.resize(framesInFlight);
+    renderFinishedSemaphores.resize(framesInFlight);
 
     VkSemaphoreCreateInfo semaphoreInfo{
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
     };
 
-    VkFenceCreateInfo fenceInfo{
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-        .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-    };
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < framesInFlight; ++i)
     {
         GSGE_CHECK_RESULT(vkCreateSemaphore(*device, &semaphoreInfo, nullptr, &imageAquiredSemaphores[i]));
         GSGE_CHECK_RESULT(vkCreateSemaphore(*device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]));
-        GSGE_CHECK_RESULT(vkCreateSemaphore(*device, &semaphoreInfo, nullptr, &prePresentCompleteSemaphores[i]));
-        GSGE_CHECK_RESULT(vkCreateSemaphore(*device, &semaphoreInfo, nullptr, &transferFinishedSemaphores[i]));
-        GSGE_CHECK_RESULT(vkCreateFence(*device, &fenceInfo, nullptr, &drawingFinishedFences[i]));
-        GSGE_CHECK_RESULT(vkCreateFence(*device, &fenceInfo, nullptr, &transferFinishedFences[i]));
     }
 
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(drawingFinishedFences, "Drawing finished fence");
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(transferFinishedFences, "Transfer finished fence");
     GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(imageAquiredSemaphores, "Image acquired semaphore");
     GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(renderFinishedSemaphores, "Render finished semaphore");
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(prePresentCompleteSemaphores, "Pre-present complete semaphore");
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(transferFinishedSemaphores, "Transfer finished semaphore");
-    SPDLOG_TRACE("[Synchronization objects] Created");
 }
 
-/**
- * @brief Destroy syncronization objects.
- *
- */
-void vulkan::destroySyncObjects()
+void vulkan::destroySwapchainSemaphores()
 {
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < framesInFlight; ++i)
     {
         vkDestroySemaphore(*device, imageAquiredSemaphores[i], nullptr);
         vkDestroySemaphore(*device, renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(*device, prePresentCompleteSemaphores[i], nullptr);
-        vkDestroySemaphore(*device, transferFinishedSemaphores[i], nullptr);
-        vkDestroyFence(*device, transferFinishedFences[i], nullptr);
-        vkDestroyFence(*device, drawingFinishedFences[i], nullptr);
     }
-
-    SPDLOG_TRACE("[Synchronization objects] Destroyed");
 }
 
 void vulkan::createVertexBindingDescriptors()
@@ -822,45 +1654,14 @@ void vulkan::createVertexBindingDescriptors()
 void vulkan::createVertexBuffer()
 {
     VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void *data;
-    GSGE_CHECK_RESULT(vkMapMemory(*device, stagingBufferMemory, 0, bufferSize, 0, &data));
-    memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(*device, stagingBufferMemory);
-
     createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferAllocation);
 
-    copyBuffer(stagingBuffer, vertexBuffer, bufferSize, false);
-
-    GSGE_CHECK_RESULT(vkWaitForFences(*device, 1, &transferFinishedFences[currentFrame], VK_TRUE, UINT64_MAX));
-    vkDestroyBuffer(*device, stagingBuffer, nullptr);
-    vkFreeMemory(*device, stagingBufferMemory, nullptr);
+    uploadBuffer(vertexBuffer, vertices.data(), bufferSize);
 
     GSGE_DEBUGGER_SET_OBJECT_NAME(vertexBuffer, "Vertex buffer");
 }
 
-uint32_t vulkan::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(device->getPhysicalDeviceHandle(), &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-    {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("failed to find suitable memory type!");
-}
-
 void vulkan::prepareVertexData(glm::vec3 *dataPtr, size_t len)
 {
     vertices.assign(dataPtr, dataPtr + len);
@@ -868,7 +1669,12 @@ void vulkan::prepareVertexData(glm::vec3 *dataPtr, size_t len)
 
 void vulkan::prepareIndexData(glm::u16 *dataPtr, size_t len)
 {
-    indices.assign(dataPtr, dataPtr + len);
+    indices16.assign(dataPtr, dataPtr + len);
+}
+
+void vulkan::prepareIndexData(glm::u32 *dataPtr, size_t len)
+{
+    indices32.assign(dataPtr, dataPtr + len);
 }
 
 void vulkan::prepareNormalsData(glm::vec3 *dataPtr, size_t len)
@@ -876,14 +1682,22 @@ void vulkan::prepareNormalsData(glm::vec3 *dataPtr, size_t len)
     vertexNormals.assign(dataPtr, dataPtr + len);
 }
 
-void vulkan::prepareIndexOffsets(std::vector<uint32_t> data)
+void vulkan::prepareDrawGroups(std::vector<MeshDrawGroup> data)
 {
-    indexOffsets.assign(data.begin(), data.end());
+    drawGroups.assign(data.begin(), data.end());
+
+    // Cull objects follow draw group order, 16-bit indexed objects come first
+    firstUint32Object = 0;
+    for (const auto &group : drawGroups)
+    {
+        if (group.indexType == IndexType::Uint16)
+            firstUint32Object += group.instanceCount;
+    }
 }
 
-void vulkan::prepareVertexOffsets(std::vector<uint32_t> data)
+void vulkan::prepareObjectCullData(std::vector<ObjectCullData> data)
 {
-    vertexOffsets.assign(data.begin(), data.end());
+    objectCullData.assign(data.begin(), data.end());
 }
 
 void vulkan::pushTransformMatricesToGpu(std::vector<DirectX::XMMATRIX> &data)
@@ -891,67 +1705,100 @@ void vulkan::pushTransformMatricesToGpu(std::vector<DirectX::XMMATRIX> &data)
     transformMatrices = &data;
 }
 
+void vulkan::prepareMotionStates(std::vector<MotionState> data)
+{
+    motionStates.assign(data.begin(), data.end());
+}
+
+void vulkan::setTransformIntegrationStep(float dt)
+{
+    integrationStep = dt;
+}
+
+/**
+ * \brief Create buffer with memory sub-allocated from the device allocator.
+ *
+ * \param sharedWithTransferQueue Share buffer concurrently between graphics and transfer queue families, so that its
+ * contents stay valid without queue family ownership transfers.
+ * \param allocationFlags Additional VMA flags, e.g. to request host access to device local memory when available
+ * \param sharedWithComputeQueue Share buffer with the compute queue family as well
+ */
 void vulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
-                          VkDeviceMemory &bufferMemory)
+                          VmaAllocation &bufferAllocation, bool sharedWithTransferQueue, VmaAllocationCreateFlags allocationFlags,
+                          bool sharedWithComputeQueue)
 {
+    std::vector<uint32_t> queueFamilyIndices = {device->getGraphicsQueueFamilyIdx()};
+    if (sharedWithTransferQueue)
+        queueFamilyIndices.push_back(device->getTransferQueueFamilyIdx());
+    if (sharedWithComputeQueue)
+        queueFamilyIndices.push_back(device->getComputeQueueFamilyIdx());
+
+    // Families may coincide, concurrent sharing requires unique indices
+    std::sort(queueFamilyIndices.begin(), queueFamilyIndices.end());
+    queueFamilyIndices.erase(std::unique(queueFamilyIndices.begin(), queueFamilyIndices.end()), queueFamilyIndices.end());
+    bool concurrent = queueFamilyIndices.size() > 1;
+
     VkBufferCreateInfo bufferInfo{
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size = size,
         .usage = usage,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0,
+        .pQueueFamilyIndices = concurrent ? queueFamilyIndices.data() : nullptr,
     };
 
-    GSGE_CHECK_RESULT(vkCreateBuffer(*device, &bufferInfo, nullptr, &buffer));
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(*device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties),
+    // Host visible buffers are only written sequentially by the host (staging, uniforms), VMA picks the memory type
+    VmaAllocationCreateInfo allocationInfo{
+        .flags = allocationFlags | ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+                                        ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+                                        : VmaAllocationCreateFlags{0}),
+        .usage = VMA_MEMORY_USAGE_AUTO,
+        .requiredFlags = properties,
     };
 
-    GSGE_CHECK_RESULT(vkAllocateMemory(*device, &allocInfo, nullptr, &bufferMemory));
+    GSGE_CHECK_RESULT(vmaCreateBuffer(device->getAllocator(), &bufferInfo, &allocationInfo, &buffer, &bufferAllocation, nullptr));
+}
 
-    VkBindBufferMemoryInfo bindInfo{
-        .sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO,
-        .buffer = buffer,
-        .memory = bufferMemory,
-        .memoryOffset = 0,
+uint64_t vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+{
+    VkBufferCopy2 copyRegion{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+        .pNext = VK_NULL_HANDLE,
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size = size,
     };
 
-    GSGE_CHECK_RESULT(vkBindBufferMemory2(*device, 1, &bindInfo));
+    return copyBuffer(srcBuffer, dstBuffer, std::vector<VkBufferCopy2>{copyRegion});
 }
 
-void vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, bool withSemaphores)
+/**
+ * \brief Copy regions of srcBuffer to dstBuffer on the transfer queue.
+ *
+ * Records into a command buffer of the current frame's transfer pool, which is recycled once the frame retires.
+ *
+ * \return Transfer timeline value signalled when the copy is finished, to wait for on the CPU or on another queue
+ */
+uint64_t vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy2> &regions,
+                            std::optional<GpuScope> profilerScope)
 {
     VkCommandBufferBeginInfo beginInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
     };
 
-    GSGE_CHECK_RESULT(vkWaitForFences(*device, 1, &transferFinishedFences[currentFrame], VK_FALSE, UINT64_MAX));
-    GSGE_CHECK_RESULT(vkResetFences(*device, 1, &transferFinishedFences[currentFrame]));
+    VkCommandBuffer commandBuffer = transferCommandPools[currentFrame]->acquire();
 
-    GSGE_CHECK_RESULT(vkBeginCommandBuffer(transferCommandBuffers[currentFrame], &beginInfo));
-    GSGE_DEBUGGER_CMD_BUFFER_LABEL_BEGIN(transferCommandBuffers[currentFrame], "transfer CB");
-
-    VkBufferCopy2 copyRegion{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
-        .pNext = VK_NULL_HANDLE,
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size,
-    };
+    GSGE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_BEGIN(commandBuffer, "transfer CB");
 
     VkCopyBufferInfo2 cbi{
         .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
         .pNext = VK_NULL_HANDLE,
         .srcBuffer = srcBuffer,
         .dstBuffer = dstBuffer,
-        .regionCount = 1,
-        .pRegions = &copyRegion,
+        .regionCount = static_cast<uint32_t>(regions.size()),
+        .pRegions = regions.data(),
     };
 
     /*
@@ -969,9 +1816,9 @@ void vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize siz
     If the values of srcQueueFamilyIndex and dstQueueFamilyIndex are equal, no ownership transfer is performed,
     and the barrier operates as if they were both set to VK_QUEUE_FAMILY_IGNORED.
 
-    NOTE: If an application does not need the contents of a resource to remain valid when transferring from one queue family to
-    another, then the ownership transfer should be skipped. - since transform matrices buffer is updated every frame we do not
-    care about it's contents from previous frame and do not need to transfer ownership back from graphics queue family
+    NOTE: Transform matrices buffers are updated sparsely, so their contents have to remain valid between frames. Instead of
+    transferring ownership back and forth every frame they are created with VK_SHARING_MODE_CONCURRENT for graphics and
+    transfer queue families, and the transfer timeline semaphore alone orders the copy before the draw.
 
     https://registry.khronos.org/vulkan/specs/1.3-extensions/html/chap7.html#synchronization-queue-transfers
     */
@@ -994,61 +1841,39 @@ void vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize siz
         .pBufferMemoryBarriers = &host_write_complete,
     };
 
-    vkCmdPipelineBarrier2(transferCommandBuffers[currentFrame], &host_write_depInfo);
-
-    vkCmdCopyBuffer2(transferCommandBuffers[currentFrame], &cbi);
-
-    if (withSemaphores)
-    {
-        // Release buffer ownership from transfer queue family
-        // Second synchronization and access scopes do not synchronize operations on that queue
-        VkBufferMemoryBarrier2 memBarrier{
-            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
-            .pNext = VK_NULL_HANDLE,
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .dstStageMask = 0,
-            .dstAccessMask = 0,
-            .srcQueueFamilyIndex = device->getTransferQueueFamilyIdx(),
-            .dstQueueFamilyIndex = device->getGraphicsQueueFamilyIdx(),
-            .buffer = dstBuffer,
-            .offset = 0,
-            .size = VK_WHOLE_SIZE,
-        };
-
-        VkDependencyInfo depInfo{
-            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-            .bufferMemoryBarrierCount = 1,
-            .pBufferMemoryBarriers = &memBarrier,
-        };
+    vkCmdPipelineBarrier2(commandBuffer, &host_write_depInfo);
 
-        vkCmdPipelineBarrier2(transferCommandBuffers[currentFrame], &depInfo);
-    }
+    // The transfer queue has no Tracy context, the copy is measured by the profiler only
+    if (profilerScope)
+        gpuProfiler->begin(commandBuffer, *profilerScope);
+    vkCmdCopyBuffer2(commandBuffer, &cbi);
+    if (profilerScope)
+        gpuProfiler->end(commandBuffer, *profilerScope);
 
-    GSGE_DEBUGGER_CMD_BUFFER_LABEL_END(transferCommandBuffers[currentFrame]);
-    GSGE_CHECK_RESULT(vkEndCommandBuffer(transferCommandBuffers[currentFrame]));
+    GSGE_DEBUGGER_CMD_BUFFER_LABEL_END(commandBuffer);
+    GSGE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 
     VkCommandBufferSubmitInfo cbSubmitInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .commandBuffer = transferCommandBuffers[currentFrame],
+        .commandBuffer = commandBuffer,
     };
 
-    // Semaphore to signal completion of transfer operation
-    VkSemaphoreSubmitInfo transferSemaphoreInfo{
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = transferFinishedSemaphores[currentFrame],
-        .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-    };
+    // Timeline value to signal completion of transfer operation
+    frameTransferValues[currentFrame] = transferTimeline->next();
+    VkSemaphoreSubmitInfo transferSemaphoreInfo =
+        transferTimeline->getSubmitInfo(frameTransferValues[currentFrame], VK_PIPELINE_STAGE_2_TRANSFER_BIT);
 
     VkSubmitInfo2 submitInfo{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
         .commandBufferInfoCount = 1,
         .pCommandBufferInfos = &cbSubmitInfo,
-        .signalSemaphoreInfoCount = static_cast<uint32_t>(withSemaphores ? 1 : 0),
-        .pSignalSemaphoreInfos = withSemaphores ? &transferSemaphoreInfo : nullptr,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &transferSemaphoreInfo,
     };
 
-    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getTransferQueue(), 1, &submitInfo, transferFinishedFences[currentFrame]));
+    GSGE_CHECK_RESULT(vkQueueSubmit2(device->getTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE));
+
+    return frameTransferValues[currentFrame];
 }
 
 void vulkan::createDescriptorSetLayouts()
@@ -1056,7 +1881,7 @@ void vulkan::createDescriptorSetLayouts()
     // uniform buffer descriptor set
     std::array<VkDescriptorSetLayoutBinding, 2> descriptorSetLayoutBinding{};
     descriptorSetLayoutBinding[0].binding = 0;
-    descriptorSetLayoutBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptorSetLayoutBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptorSetLayoutBinding[0].descriptorCount = 1;
     descriptorSetLayoutBinding[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     descriptorSetLayoutBinding[0].pImmutableSamplers = nullptr;
@@ -1075,40 +1900,89 @@ void vulkan::createDescriptorSetLayouts()
     };
 
     GSGE_CHECK_RESULT(vkCreateDescriptorSetLayout(*device, &layoutInfo, nullptr, &descriptorSetLayout));
-    
+
+    // culling descriptor set: object bounds, transform matrices, indirect draw commands and draw count
+    std::array<VkDescriptorSetLayoutBinding, 4> cullSetLayoutBinding{};
+    for (uint32_t i = 0; i < cullSetLayoutBinding.size(); i++)
+    {
+        cullSetLayoutBinding[i].binding = i;
+        cullSetLayoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cullSetLayoutBinding[i].descriptorCount = 1;
+        cullSetLayoutBinding[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullSetLayoutBinding[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo cullLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(cullSetLayoutBinding.size()),
+        .pBindings = cullSetLayoutBinding.data(),
+    };
+
+    GSGE_CHECK_RESULT(vkCreateDescriptorSetLayout(*device, &cullLayoutInfo, nullptr, &cullDescriptorSetLayout));
+
     SPDLOG_TRACE("[Descriptor set layouts] Created");
 }
 
-void vulkan::createUniformBuffers()
+/**
+ * \brief Create upload ring with a partition per frame in flight.
+ *
+ * A partition holds the uniforms and a full upload of transform matrices, so every frame fits in its partition.
+ */
+void vulkan::createUploadRing()
 {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    // Alignment padding of both slices, minUniformBufferOffsetAlignment is at most 256
+    VkDeviceSize frameSize = sizeof(UniformBufferObject) + sizeof(DirectX::XMMATRIX) * ((*transformMatrices).size() + 1) + 256;
 
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    uploadRing = std::make_unique<UploadRing>(device, framesInFlight, std::max(frameSize, uploadRingMinFrameSize));
+}
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+/**
+ * \brief Upload data to a device local buffer through the current frame's partition of the upload ring.
+ *
+ * Data larger than a partition is copied in chunks, each chunk waits for the previous copy to finish. Meant for
+ * initial uploads, the partition is recycled on return.
+ */
+void vulkan::uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size)
+{
+    for (VkDeviceSize offset = 0; offset < size;)
     {
-        createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i],
-                     uniformBuffersMemory[i]);
+        uploadRing->beginFrame(currentFrame);
+
+        VkDeviceSize chunkSize = std::min(size - offset, uploadRing->getFrameSize());
+        UploadRing::Slice slice = uploadRing->allocate(chunkSize, 16);
+        memcpy(slice.data, static_cast<const char *>(data) + offset, static_cast<size_t>(chunkSize));
+        uploadRing->flush(slice);
+
+        VkBufferCopy2 copyRegion{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+            .pNext = VK_NULL_HANDLE,
+            .srcOffset = slice.offset,
+            .dstOffset = offset,
+            .size = chunkSize,
+        };
+
+        transferTimeline->wait(copyBuffer(slice.buffer, dstBuffer, std::vector<VkBufferCopy2>{copyRegion}));
+        // Initial uploads happen outside the frame loop, recycle the copy's command buffer right away
+        transferCommandPools[currentFrame]->reset();
+
+        offset += chunkSize;
     }
 
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(uniformBuffers, "Uniform buffer");
-    SPDLOG_TRACE("[Uniform buffers] Created");
+    uploadRing->beginFrame(currentFrame);
 }
 
 void vulkan::createDescriptorPool()
 {
     std::array<VkDescriptorPoolSize, 2> poolSize{};
-    poolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSize[0].descriptorCount = framesInFlight;
     poolSize[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSize[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSize[1].descriptorCount = framesInFlight * 7; // 1 graphics + 4 culling + 2 integration per frame
 
     VkDescriptorPoolCreateInfo poolInfo{
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .flags = 0,
-        .maxSets = 20,
+        .maxSets = framesInFlight * 3, // graphics, culling and integration set per frame
         .poolSizeCount = static_cast<uint32_t>(poolSize.size()),
         .pPoolSizes = poolSize.data(),
     };
@@ -1119,22 +1993,22 @@ void vulkan::createDescriptorPool()
 
 void vulkan::createDescriptorSets()
 {
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
         .descriptorPool = descriptorPool,
-        .descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+        .descriptorSetCount = framesInFlight,
         .pSetLayouts = layouts.data(),
     };
 
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    descriptorSets.resize(framesInFlight);
     GSGE_CHECK_RESULT(vkAllocateDescriptorSets(*device, &allocInfo, descriptorSets.data()));
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < framesInFlight; i++)
     {
         std::array<VkDescriptorBufferInfo, 2> bufferInfo{};
-        // UBO buffer info
-        bufferInfo[0].buffer = uniformBuffers[i];
+        // UBO buffer info, offset of the current frame's slice is passed when binding
+        bufferInfo[0].buffer = *uploadRing;
         bufferInfo[0].offset = 0;
         bufferInfo[0].range = sizeof(UniformBufferObject);
 
@@ -1149,7 +2023,7 @@ void vulkan::createDescriptorSets()
         descriptorWrite[0].dstSet = descriptorSets[i];
         descriptorWrite[0].dstBinding = 0;
         descriptorWrite[0].dstArrayElement = 0;
-        descriptorWrite[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrite[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorWrite[0].descriptorCount = 1;
         descriptorWrite[0].pBufferInfo = &bufferInfo[0];
 
@@ -1165,6 +2039,69 @@ void vulkan::createDescriptorSets()
         vkUpdateDescriptorSets(*device, 2, descriptorWrite.data(), 0, nullptr);
     }
 
+    // culling descriptor sets
+    std::vector<VkDescriptorSetLayout> cullLayouts(framesInFlight, cullDescriptorSetLayout);
+    allocInfo.pSetLayouts = cullLayouts.data();
+
+    cullDescriptorSets.resize(framesInFlight);
+    GSGE_CHECK_RESULT(vkAllocateDescriptorSets(*device, &allocInfo, cullDescriptorSets.data()));
+
+    for (size_t i = 0; i < framesInFlight; i++)
+    {
+        std::array<VkDescriptorBufferInfo, 4> bufferInfo{};
+        bufferInfo[0] = {objectCullBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfo[1] = {transformMatricesBuffer[i], 0, VK_WHOLE_SIZE};
+        bufferInfo[2] = {indirectDrawBuffers[i], 0, VK_WHOLE_SIZE};
+        bufferInfo[3] = {drawCountBuffers[i], 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 4> descriptorWrite{};
+        for (uint32_t binding = 0; binding < descriptorWrite.size(); binding++)
+        {
+            descriptorWrite[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite[binding].dstSet = cullDescriptorSets[i];
+            descriptorWrite[binding].dstBinding = binding;
+            descriptorWrite[binding].dstArrayElement = 0;
+            descriptorWrite[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite[binding].descriptorCount = 1;
+            descriptorWrite[binding].pBufferInfo = &bufferInfo[binding];
+        }
+
+        vkUpdateDescriptorSets(*device, static_cast<uint32_t>(descriptorWrite.size()), descriptorWrite.data(), 0, nullptr);
+    }
+
+    // integration descriptor sets, only used with GPU transform integration
+    integrateDescriptorSets.clear();
+    if (gpuTransforms)
+    {
+        std::vector<VkDescriptorSetLayout> integrateLayouts(framesInFlight, integrateDescriptorSetLayout);
+        allocInfo.pSetLayouts = integrateLayouts.data();
+
+        integrateDescriptorSets.resize(framesInFlight);
+        GSGE_CHECK_RESULT(vkAllocateDescriptorSets(*device, &allocInfo, integrateDescriptorSets.data()));
+
+        for (size_t i = 0; i < framesInFlight; i++)
+        {
+            std::array<VkDescriptorBufferInfo, 2> bufferInfo{};
+            bufferInfo[0] = {motionStateBuffer, 0, VK_WHOLE_SIZE};
+            bufferInfo[1] = {transformMatricesBuffer[i], 0, VK_WHOLE_SIZE};
+
+            std::array<VkWriteDescriptorSet, 2> descriptorWrite{};
+            for (uint32_t binding = 0; binding < descriptorWrite.size(); binding++)
+            {
+                descriptorWrite[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrite[binding].dstSet = integrateDescriptorSets[i];
+                descriptorWrite[binding].dstBinding = binding;
+                descriptorWrite[binding].dstArrayElement = 0;
+                descriptorWrite[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                descriptorWrite[binding].descriptorCount = 1;
+                descriptorWrite[binding].pBufferInfo = &bufferInfo[binding];
+            }
+
+            vkUpdateDescriptorSets(*device, static_cast<uint32_t>(descriptorWrite.size()), descriptorWrite.data(), 0,
+                                   nullptr);
+        }
+    }
+
     SPDLOG_TRACE("[Descriptor sets] created");
 }
 
@@ -1173,82 +2110,321 @@ void vulkan::updateUniformBufferEx(UniformBufferObject ubo)
     local_ubo = ubo;
 }
 
+/**
+ * \brief Write uniforms to a slice of the upload ring, draws of the frame bind it with a dynamic offset.
+ */
 void vulkan::updateUniformBuffer(uint32_t currentImage)
 {
-    void *data;
-    GSGE_CHECK_RESULT(vkMapMemory(*device, uniformBuffersMemory[currentImage], 0, sizeof(local_ubo), 0, &data));
-    memcpy(data, &local_ubo, sizeof(local_ubo));
-    vkUnmapMemory(*device, uniformBuffersMemory[currentImage]);
+    UploadRing::Slice slice = uploadRing->allocate(sizeof(local_ubo), uploadRing->getUniformAlignment());
+    memcpy(slice.data, &local_ubo, sizeof(local_ubo));
+    uploadRing->flush(slice);
+
+    uniformBufferOffset = static_cast<uint32_t>(slice.offset);
 }
 
-void vulkan::createIndexBuffer()
+/**
+ * \brief Create index buffer of every index type used by the scene, 16-bit and 32-bit indices are bound separately.
+ */
+void vulkan::createIndexBuffers()
 {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+    if (!indices16.empty())
+        createIndexBuffer(IndexType::Uint16, indices16.data(), sizeof(glm::u16) * indices16.size());
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    if (!indices32.empty())
+        createIndexBuffer(IndexType::Uint32, indices32.data(), sizeof(glm::u32) * indices32.size());
+}
 
-    void *data;
-    GSGE_CHECK_RESULT(vkMapMemory(*device, stagingBufferMemory, 0, bufferSize, 0, &data));
-    memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(*device, stagingBufferMemory);
+void vulkan::createIndexBuffer(IndexType indexType, const void *indexData, VkDeviceSize bufferSize)
+{
+    VkBuffer &indexBuffer = indexBuffers[static_cast<size_t>(indexType)];
+    VmaAllocation &indexBufferAllocation = indexBuffersAllocation[static_cast<size_t>(indexType)];
 
     createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferAllocation);
 
-    copyBuffer(stagingBuffer, indexBuffer, bufferSize, false);
+    uploadBuffer(indexBuffer, indexData, bufferSize);
 
-    GSGE_CHECK_RESULT(vkWaitForFences(*device, 1, &transferFinishedFences[currentFrame], VK_TRUE, UINT64_MAX));
-    vkDestroyBuffer(*device, stagingBuffer, nullptr);
-    vkFreeMemory(*device, stagingBufferMemory, nullptr);
+    GSGE_DEBUGGER_SET_OBJECT_NAME(indexBuffer, indexType == IndexType::Uint16 ? "Index buffer 16" : "Index buffer 32");
+}
 
-    GSGE_DEBUGGER_SET_OBJECT_NAME(indexBuffer, "Index buffer");
+VkIndexType vulkan::toVkIndexType(IndexType indexType)
+{
+    return indexType == IndexType::Uint16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
 }
 
+/**
+ * \brief Create device buffers of transform matrices, one per frame in flight.
+ *
+ * With directTransformUpload the buffers ask for host visible device local memory (resizable BAR, integrated GPUs).
+ * When VMA finds it, the buffers stay mapped and matrices are written straight into them. Otherwise VMA falls back to
+ * device local memory only and matrices are copied from the upload ring on the transfer queue.
+ */
 void vulkan::createTransformMatricesBuffer()
 {
     VkDeviceSize bufferSize = sizeof((*transformMatrices)[0]) * (*transformMatrices).size();
 
-    transformMatricesBuffer.resize(MAX_FRAMES_IN_FLIGHT);
-    transformMatricesBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    transformMatricesStagingBuffer.resize(MAX_FRAMES_IN_FLIGHT);
-    transformMatricesStagingBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    transformMatricesMappedMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    transformMatricesBuffer.resize(framesInFlight);
+    transformMatricesBufferAllocation.resize(framesInFlight);
+    transformMatricesMappedMemory.resize(framesInFlight);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    pendingTransformRanges.resize(framesInFlight);
+
+    VmaAllocationCreateFlags allocationFlags = 0;
+    if (settings.Renderer.directTransformUpload)
     {
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-                     transformMatricesStagingBuffer[i], transformMatricesStagingBufferMemory[i]);
+        allocationFlags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                          VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
 
+    transformMatricesDirect = settings.Renderer.directTransformUpload;
+
+    for (size_t i = 0; i < framesInFlight; ++i)
+    {
         createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, transformMatricesBuffer[i], transformMatricesBufferMemory[i]);
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, transformMatricesBuffer[i], transformMatricesBufferAllocation[i], true,
+                     allocationFlags, gpuTransforms);
 
-        vkMapMemory(*device, transformMatricesStagingBufferMemory[i], 0, bufferSize, 0, &transformMatricesMappedMemory[i]);
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(device->getAllocator(), transformMatricesBufferAllocation[i], &allocationInfo);
+        VkMemoryPropertyFlags memoryFlags;
+        vmaGetAllocationMemoryProperties(device->getAllocator(), transformMatricesBufferAllocation[i], &memoryFlags);
+
+        // Buffers are created with the transfer usage, staging keeps working if any of them is not host visible
+        transformMatricesMappedMemory[i] = allocationInfo.pMappedData;
+        transformMatricesDirect = transformMatricesDirect && (memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+                                  allocationInfo.pMappedData != nullptr;
+
+        // Every buffer starts with a full upload
+        pendingTransformRanges[i] = {{0, static_cast<uint32_t>((*transformMatrices).size())}};
     }
 
+    SPDLOG_INFO("[Renderer] Transform matrices {}", transformMatricesDirect
+                                                        ? "written directly to host visible device local memory"
+                                                        : "copied from staging memory on the transfer queue");
+
     GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(transformMatricesBuffer, "Transform matrices buffer");
-    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(transformMatricesStagingBuffer, "Transform matrices staging buffer");
 }
 
+/**
+ * \brief Create object buffer of the culling pass.
+ *
+ * Object bounds and draw arguments never change, they are uploaded once to a device local buffer.
+ */
+void vulkan::createCullBuffers()
+{
+    VkDeviceSize bufferSize = sizeof(ObjectCullData) * objectCullData.size();
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, objectCullBuffer, objectCullBufferAllocation);
+
+    uploadBuffer(objectCullBuffer, objectCullData.data(), bufferSize);
+
+    GSGE_DEBUGGER_SET_OBJECT_NAME(objectCullBuffer, "Object cull buffer");
+}
+
+/**
+ * \brief Create indirect draw and draw count buffers of every frame in flight, rewritten by the culling pass each frame.
+ */
+void vulkan::createIndirectDrawBuffers()
+{
+    indirectDrawBuffers.resize(framesInFlight);
+    indirectDrawBuffersAllocation.resize(framesInFlight);
+    drawCountBuffers.resize(framesInFlight);
+    drawCountBuffersAllocation.resize(framesInFlight);
+
+    for (size_t i = 0; i < framesInFlight; ++i)
+    {
+        createBuffer(sizeof(VkDrawIndexedIndirectCommand) * objectCullData.size(),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     indirectDrawBuffers[i], indirectDrawBuffersAllocation[i]);
+
+        createBuffer(sizeof(uint32_t) * static_cast<size_t>(IndexType::Count),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCountBuffers[i], drawCountBuffersAllocation[i]);
+    }
+
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(indirectDrawBuffers, "Indirect draw buffer");
+    GSGE_DEBUGGER_SET_INDEXED_OBJECT_NAME(drawCountBuffers, "Draw count buffer");
+}
+
+/**
+ * \brief Create motion state buffer of the integration pass.
+ *
+ * States are uploaded once, from then on the integration dispatch advances them in place every frame. The buffer is
+ * shared with the transfer queue for the upload and with the compute queue running the dispatch.
+ */
+void vulkan::createMotionStateBuffer()
+{
+    VkDeviceSize bufferSize = sizeof(MotionState) * motionStates.size();
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, motionStateBuffer, motionStateBufferAllocation, true, 0, true);
+
+    uploadBuffer(motionStateBuffer, motionStates.data(), bufferSize);
+
+    GSGE_DEBUGGER_SET_OBJECT_NAME(motionStateBuffer, "Motion state buffer");
+}
+
+/**
+ * \brief Queue changed transform matrices for upload to the buffers of all frames in flight.
+ *
+ * Every frame in flight has its own device buffer, so a matrix changed once has to be copied to each of them.
+ */
+void vulkan::markTransformMatricesDirty(const std::vector<DirtyRange> &ranges)
+{
+    for (auto &pending : pendingTransformRanges)
+        pending.insert(pending.end(), ranges.begin(), ranges.end());
+}
+
+/**
+ * \brief Upload matrices changed since the last use of the current frame's buffer.
+ *
+ * Pending ranges are sorted and coalesced (ranges separated by less than transformCopyMergeGap clean matrices are
+ * merged, copying a few clean matrices is cheaper than another region). Nothing is uploaded if no matrix changed.
+ */
 void vulkan::updateTransformMatrixBuffer(uint32_t currentImage)
 {
-    VkDeviceSize bufferSize = sizeof((*transformMatrices)[0]) * (*transformMatrices).size();
+    ZoneScoped;
+
+    auto &pending = pendingTransformRanges[currentImage];
+    transformTransferSubmitted = !pending.empty() && !transformMatricesDirect;
+
+    if (pending.empty())
+    {
+        TracyPlot("Transform upload bytes", int64_t(0));
+        return;
+    }
+
+    timer uploadTimer;
+
+    std::sort(pending.begin(), pending.end(), [](const DirtyRange &a, const DirtyRange &b) { return a.first < b.first; });
+
+    std::vector<DirtyRange> ranges;
+    ranges.reserve(pending.size());
+    for (const auto &range : pending)
+    {
+        if (!ranges.empty() && range.first <= ranges.back().first + ranges.back().count + transformCopyMergeGap)
+        {
+            uint32_t end = std::max(ranges.back().first + ranges.back().count, range.first + range.count);
+            ranges.back().count = end - ranges.back().first;
+        }
+        else
+        {
+            ranges.push_back(range);
+        }
+    }
+    pending.clear();
+
+    VkDeviceSize uploadSize = transformMatricesDirect ? writeTransformMatrices(currentImage, ranges)
+                                                      : stageTransformMatrices(currentImage, ranges);
+
+    reportTransformUpload(uploadTimer.getTimeAsSeconds());
+    TracyPlot("Transform upload bytes", static_cast<int64_t>(uploadSize));
+}
+
+/**
+ * \brief Write ranges straight into the mapped device buffer of the frame.
+ *
+ * The graphics timeline has reached the frame's value, so the GPU no longer reads the buffer. Host writes are visible to the
+ * following submit, no copy, transfer submit or semaphore wait is needed.
+ */
+VkDeviceSize vulkan::writeTransformMatrices(uint32_t currentImage, const std::vector<DirtyRange> &ranges)
+{
+    constexpr VkDeviceSize matrixSize = sizeof(DirectX::XMMATRIX);
+
+    std::vector<VkDeviceSize> flushOffsets;
+    std::vector<VkDeviceSize> flushSizes;
+    flushOffsets.reserve(ranges.size());
+    flushSizes.reserve(ranges.size());
+
+    VkDeviceSize uploadSize = 0;
+
+    for (const auto &range : ranges)
+    {
+        VkDeviceSize offset = range.first * matrixSize;
+        VkDeviceSize size = range.count * matrixSize;
+
+        memcpy(static_cast<char *>(transformMatricesMappedMemory[currentImage]) + offset, &(*transformMatrices)[range.first],
+               static_cast<size_t>(size));
+
+        flushOffsets.push_back(offset);
+        flushSizes.push_back(size);
+        uploadSize += size;
+    }
+
+    // VMA aligns flushed ranges to nonCoherentAtomSize and skips the flush for coherent memory
+    std::vector<VmaAllocation> flushAllocations(ranges.size(), transformMatricesBufferAllocation[currentImage]);
+    GSGE_CHECK_RESULT(vmaFlushAllocations(device->getAllocator(), static_cast<uint32_t>(flushAllocations.size()),
+                                          flushAllocations.data(), flushOffsets.data(), flushSizes.data()));
 
-    memcpy(transformMatricesMappedMemory[currentImage], (*transformMatrices).data(), static_cast<size_t>(bufferSize));
+    return uploadSize;
+}
+
+/**
+ * \brief Pack ranges into one slice of the upload ring and copy them to the device buffer on the transfer queue.
+ *
+ * Each range is copied with its own region, the draw of the frame waits for the copy on the transfer timeline.
+ */
+VkDeviceSize vulkan::stageTransformMatrices(uint32_t currentImage, const std::vector<DirtyRange> &ranges)
+{
+    constexpr VkDeviceSize matrixSize = sizeof(DirectX::XMMATRIX);
+
+    VkDeviceSize uploadSize = 0;
+    for (const auto &range : ranges)
+        uploadSize += range.count * matrixSize;
+
+    UploadRing::Slice slice = uploadRing->allocate(uploadSize, matrixSize);
+
+    std::vector<VkBufferCopy2> regions;
+    regions.reserve(ranges.size());
+
+    VkDeviceSize sliceOffset = 0;
+    for (const auto &range : ranges)
+    {
+        VkDeviceSize offset = range.first * matrixSize;
+        VkDeviceSize size = range.count * matrixSize;
+
+        memcpy(static_cast<char *>(slice.data) + sliceOffset, &(*transformMatrices)[range.first], static_cast<size_t>(size));
+
+        regions.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+            .pNext = VK_NULL_HANDLE,
+            .srcOffset = slice.offset + sliceOffset,
+            .dstOffset = offset,
+            .size = size,
+        });
+
+        sliceOffset += size;
+    }
 
     // Flush memory from host cache
-    VkMappedMemoryRange memoryRange{
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .memory = transformMatricesStagingBufferMemory[currentImage],
-        .offset = 0,
-        .size = VK_WHOLE_SIZE,
-    };
+    uploadRing->flush(slice);
+
+    transformTransferValue =
+        copyBuffer(slice.buffer, transformMatricesBuffer[currentImage], regions, GpuScope::TransformCopy);
+
+    return uploadSize;
+}
+
+/**
+ * \brief Plot host time of a transform upload and log its average every transformUploadReportInterval uploads.
+ *
+ * Direct writes are complete when the matrices are flushed, staged uploads when their copy is submitted.
+ */
+void vulkan::reportTransformUpload(float seconds)
+{
+    TracyPlot("Transform upload us", static_cast<double>(seconds) * 1e6);
+
+    transformUploadTimeTotal += seconds;
+    if (++transformUploadCount < transformUploadReportInterval)
+        return;
 
-    GSGE_CHECK_RESULT(vkFlushMappedMemoryRanges(*device, 1, &memoryRange));
+    SPDLOG_INFO("[Renderer] Transform upload ({}): {:.1f} us average over {} uploads",
+                transformMatricesDirect ? "direct" : "staging", 1e6 * transformUploadTimeTotal / transformUploadCount,
+                transformUploadCount);
 
-    copyBuffer(transformMatricesStagingBuffer[currentImage], transformMatricesBuffer[currentImage], bufferSize, true);
+    transformUploadTimeTotal = 0.0f;
+    transformUploadCount = 0;
 }
 
 /**
@@ -1279,24 +2455,10 @@ void vulkan::createVertexNormalsBuffer()
 {
     VkDeviceSize bufferSize = sizeof(vertexNormals[0]) * vertexNormals.size();
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void *data;
-    GSGE_CHECK_RESULT(vkMapMemory(*device, stagingBufferMemory, 0, bufferSize, 0, &data));
-    memcpy(data, vertexNormals.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(*device, stagingBufferMemory);
-
     createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexNormalsBuffer, vertexNormalsBufferMemory);
-
-    copyBuffer(stagingBuffer, vertexNormalsBuffer, bufferSize, false);
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexNormalsBuffer, vertexNormalsBufferAllocation);
 
-    GSGE_CHECK_RESULT(vkWaitForFences(*device, 1, &transferFinishedFences[currentFrame], VK_TRUE, UINT64_MAX));
-    vkDestroyBuffer(*device, stagingBuffer, nullptr);
-    vkFreeMemory(*device, stagingBufferMemory, nullptr);
+    uploadBuffer(vertexNormalsBuffer, vertexNormals.data(), bufferSize);
 
     GSGE_DEBUGGER_SET_OBJECT_NAME(vertexNormalsBuffer, "Vertex normals buffer");
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <fstream>
+#include <optional>
 #include <DirectXMath.h>
 
 #include <vulkan/vulkan.h>
@@ -17,15 +19,34 @@
 #include "renderer/swapchain.h"
 #include "renderer/renderPass.h"
 #include "renderer/framebuffer.h"
+#include "renderer/renderTargets.h"
 #include "renderer/commandPool.h"
+#include "renderer/uploadRing.h"
+#include "renderer/pipelineCache.h"
+#include "renderer/pipelineManager.h"
+#include "renderer/timelineSemaphore.h"
+#include "renderer/gpuProfiler.h"
 #include "renderer/debugger.h"
 #include "renderer/settings.h"
 #include "core/tools.h"
+#include "core/jobSystem.h"
+#include "timer.h"
 
 class vulkan
 {
   public:
-    vulkan(std::shared_ptr<Window> &window) : window(window){};
+    // CPU time of the phases of one update(), in seconds
+    struct FrameCpuTimes
+    {
+        float wait;    // Waiting until the GPU releases the frame's resources
+        float upload;  // Transform matrices, motion integration dispatch and uniforms
+        float record;  // Pipeline selection and command buffer recording
+        float submit;  // Graphics queue submission
+        float present; // Swapchain image acquisition and presentation
+    };
+
+    vulkan(std::shared_ptr<Window> &window, std::shared_ptr<JobSystem> &jobSystem)
+        : window(window), jobSystem(jobSystem){};
     ~vulkan();
 
     void init();
@@ -33,10 +54,14 @@ class vulkan
 
     void prepareVertexData(glm::vec3 *dataPtr, size_t length);
     void prepareIndexData(glm::u16 *dataPtr, size_t length);
+    void prepareIndexData(glm::u32 *dataPtr, size_t length);
     void prepareNormalsData(glm::vec3 *dataPtr, size_t len);
-    void prepareIndexOffsets(std::vector<uint32_t> data);
-    void prepareVertexOffsets(std::vector<uint32_t> data);
+    void prepareDrawGroups(std::vector<MeshDrawGroup> data);
     void pushTransformMatricesToGpu(std::vector<DirectX::XMMATRIX>& data);
+    void prepareObjectCullData(std::vector<ObjectCullData> data);
+    void prepareMotionStates(std::vector<MotionState> data);
+    void setTransformIntegrationStep(float dt);
+    void markTransformMatricesDirty(const std::vector<DirtyRange> &ranges);
     void updateUniformBufferEx(UniformBufferObject ubo);
     void updateUniformBuffer(uint32_t currentImage);
     void updateTransformMatrixBuffer(uint32_t currentImage);
@@ -44,30 +69,49 @@ class vulkan
     bool viewAspectChanged();
     float getViewAspect();
     void handleMSAAChange();
+    void handleRenderingModeChange();
+    void handleFrameSettingsChange();
+    void logMemoryStats();
+
+    void waitIdle(); //!< Wait for all submitted frames and retire their timings
+    const std::vector<GpuFrameTimes> &getRetiredFrameTimings() const; //!< Frames retired by last update() or waitIdle()
+    uint64_t getSubmittedFrameCount() const;                          //!< Number of the next frame submitted
+    const FrameCpuTimes &getFrameCpuTimes() const;                    //!< Phases of the last update()
+    void saveFrameImage(const std::string &fileName);                //!< Write latest frame to a PNG file, headless only
 
   private:
     std::shared_ptr<Window> window;
+    std::shared_ptr<JobSystem> jobSystem;
     std::shared_ptr<Instance> instance;
     std::shared_ptr<Surface> surface;
     std::shared_ptr<Device> device;
     std::shared_ptr<Swapchain> swapchain;
-    std::shared_ptr<RenderPass> renderPass;
-    std::shared_ptr<Framebuffer> framebuffer;   
-    std::unique_ptr<CommandPool> graphicsCommandPool;
-    std::unique_ptr<CommandPool> transferCommandPool;
-    std::unique_ptr<CommandPool> presentCommandPool;
+    std::shared_ptr<RenderTargets> renderTargets;
+    std::shared_ptr<RenderPass> renderPass;   // Null with dynamic rendering
+    std::shared_ptr<Framebuffer> framebuffer; // Null with dynamic rendering
+    // Transient pools of each frame in flight, reset as a whole once the frame's work has retired
+    std::vector<std::unique_ptr<CommandPool>> graphicsCommandPools;
+    std::vector<std::unique_ptr<CommandPool>> transferCommandPools;
+    std::vector<std::unique_ptr<CommandPool>> presentCommandPools;
+    std::unique_ptr<UploadRing> uploadRing;
+    std::unique_ptr<PipelineCache> pipelineCache;
+    std::unique_ptr<PipelineManager> pipelineManager;
 
     GSGE_DEBUGGER_INSTANCE_DECL;
     GSGE_SETTINGS_INSTANCE_DECL;
 
     uint32_t currentFrame{0};
     uint32_t swapchainImageIndex{0};
-    const int MAX_FRAMES_IN_FLIGHT = 2;
+    uint32_t framesInFlight{2}; // Taken from settings on (re)creation of per-frame resources
     bool swapchainAspectChanged{true};    
     bool isResizing{false};
+    bool headless{false}; // Offscreen images instead of a window surface, nothing is acquired or presented
+    bool dynamicRenderingSupported{false}; // dynamicRendering feature is enabled on the device
+    bool dynamicRendering{false};          // Mode the render targets and graphics pipeline were created for
 
-    VkPipelineLayout pipelineLayout;
-    VkPipeline graphicsPipeline;
+    VkPipelineLayout pipelineLayout; // Shared by all graphics pipeline permutations
+    VkPipeline graphicsPipeline{VK_NULL_HANDLE}; // Permutation bound by this frame's draws, see selectGraphicsPipeline()
+    GraphicsPipelineKey graphicsPipelineKey;     // Key of graphicsPipeline
 
     std::vector<VkVertexInputBindingDescription> vertexBindingDesc;
     std::vector<VkVertexInputAttributeDescription> vertexAttrDesc;
@@ -76,79 +120,168 @@ class vulkan
     VkDescriptorSetLayout descriptorSetLayout;
     std::vector<VkDescriptorSet> descriptorSets;
 
-    std::vector<VkCommandBuffer> graphicsCommandBuffers;
-    std::vector<VkCommandBuffer> transferCommandBuffers;
-    std::vector<VkCommandBuffer> presentCommandBuffers;
+    // GPU-driven rendering: frustum culling compute pass writing indirect draw commands
+    bool gpuDrivenSupported{false}; // drawIndirectCount feature is enabled on the device
+    static constexpr uint32_t cullWorkgroupSize = 64; // local_size_x of shaders/cull.comp
+    VkPipelineLayout cullPipelineLayout;
+    VkPipeline cullPipeline;
+    VkDescriptorSetLayout cullDescriptorSetLayout;
+    std::vector<VkDescriptorSet> cullDescriptorSets;
+
+    // GPU transform integration: motion of dynamic transforms lives in a device buffer and is integrated on the async
+    // compute queue, the matrices are written to the frame's transform buffer before the graphics submit reads them
+    bool gpuTransforms{false};                             // Motion states were prepared and --gpu-transforms is set
+    static constexpr uint32_t integrateWorkgroupSize = 64; // local_size_x of shaders/integrate.comp
+    VkPipelineLayout integratePipelineLayout{VK_NULL_HANDLE};
+    VkPipeline integratePipeline{VK_NULL_HANDLE};
+    VkDescriptorSetLayout integrateDescriptorSetLayout{VK_NULL_HANDLE};
+    std::vector<VkDescriptorSet> integrateDescriptorSets;
+    std::vector<std::unique_ptr<CommandPool>> computeCommandPools;
+    float integrationStep{0.0f}; // Time the motion states advance by in the next dispatch
 
+    // Parallel recording of CPU draws, one pool per recorder and frame in flight. A pool belongs to a recorder slot,
+    // not a thread, so whichever thread runs a slot's job is the only one touching it
+    static constexpr size_t minDrawGroupsPerRecorder = 64; // Fewer groups are not worth a secondary command buffer
+    uint32_t recorderCount{1};                             // Job system threads, taken on creation of frame resources
+    std::vector<std::unique_ptr<CommandPool>> secondaryCommandPools; // [frame * recorderCount + recorder]
+    std::vector<VkCommandBuffer> secondaryCommandBuffers;            // Recorded this frame, same indexing as the pools
+
+    // Swapchain acquire and present take binary semaphores only, everything else is ordered by timelines
     std::vector<VkSemaphore> imageAquiredSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkSemaphore> prePresentCompleteSemaphores;
-    std::vector<VkSemaphore> transferFinishedSemaphores;
-    std::vector<VkFence> drawingFinishedFences;
-    std::vector<VkFence> transferFinishedFences;
+    std::unique_ptr<TimelineSemaphore> graphicsTimeline;
+    std::unique_ptr<TimelineSemaphore> transferTimeline;
+    std::unique_ptr<TimelineSemaphore> computeTimeline;
+    std::vector<uint64_t> frameGraphicsValues; // Graphics timeline value signalled by the latest submit of each frame
+    std::vector<uint64_t> frameTransferValues; // Transfer timeline value of the latest submit of each frame's command buffer
+    std::vector<uint64_t> frameComputeValues;  // Compute timeline value of the latest submit of each frame's command buffer
+
+    // GPU time of the passes of each frame in flight, timestamps are read once the frame retires
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    uint64_t submittedFrameCount{0};
+    FrameCpuTimes frameCpuTimes{};
+    timer phaseTimer; // Reset at the end of every phase measured in frameCpuTimes
 
     VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    VmaAllocation vertexBufferAllocation;
+    std::array<VkBuffer, static_cast<size_t>(IndexType::Count)> indexBuffers{}; // One per index type, null if unused
+    std::array<VmaAllocation, static_cast<size_t>(IndexType::Count)> indexBuffersAllocation{};
     VkBuffer vertexNormalsBuffer;
-    VkDeviceMemory vertexNormalsBufferMemory;
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    VmaAllocation vertexNormalsBufferAllocation;
+
+    // per-frame uploads, uniforms are bound from the upload ring with a dynamic offset
+    static constexpr VkDeviceSize uploadRingMinFrameSize = 4 * 1024 * 1024; // Also the chunk size of initial uploads
+    uint32_t uniformBufferOffset{0};                                          // Offset of current frame's uniforms
 
-    // transform matrices buffers
-    std::vector<VkBuffer> transformMatricesStagingBuffer;
-    std::vector<VkDeviceMemory> transformMatricesStagingBufferMemory;
+    // transform matrices buffers, changed matrices are staged in the upload ring unless written directly
     std::vector<VkBuffer> transformMatricesBuffer;
-    std::vector<VkDeviceMemory> transformMatricesBufferMemory;
-    std::vector<void*> transformMatricesMappedMemory;
+    std::vector<VmaAllocation> transformMatricesBufferAllocation;
+    std::vector<void *> transformMatricesMappedMemory;           // Null unless transformMatricesDirect
+    bool transformMatricesDirect{false};                         // Buffers are host visible device local memory
+    std::vector<std::vector<DirtyRange>> pendingTransformRanges; // Ranges not uploaded yet to the buffer of each frame
+    bool transformTransferSubmitted{false};                      // Draw of current frame waits for transformTransferValue
+    uint64_t transformTransferValue{0};                          // Transfer timeline value of the matrices copy
+    static constexpr uint32_t transformCopyMergeGap = 4;         // Clean matrices copied to save a copy region
+    bool transformComputeSubmitted{false};                       // Draw of current frame waits for transformComputeValue
+    uint64_t transformComputeValue{0};                           // Compute timeline value of the integration dispatch
+
+    // host time of transform uploads, averaged and logged every transformUploadReportInterval uploads
+    static constexpr uint32_t transformUploadReportInterval = 1000;
+    float transformUploadTimeTotal{0.0f};
+    uint32_t transformUploadCount{0};
+
+    // culling buffers, object data is static, draw commands and their count are written every frame
+    VkBuffer objectCullBuffer;
+    VmaAllocation objectCullBufferAllocation;
+    std::vector<VkBuffer> indirectDrawBuffers;
+    std::vector<VmaAllocation> indirectDrawBuffersAllocation;
+    std::vector<VkBuffer> drawCountBuffers;
+    std::vector<VmaAllocation> drawCountBuffersAllocation;
+
+    // motion states of dynamic transforms, read and written only by the integration dispatch
+    VkBuffer motionStateBuffer{VK_NULL_HANDLE};
+    VmaAllocation motionStateBufferAllocation{VK_NULL_HANDLE};
 
     UniformBufferObject local_ubo;
 
     std::vector<glm::vec3> vertices;
-    std::vector<glm::u16> indices;
+    std::vector<glm::u16> indices16;
+    std::vector<glm::u32> indices32;
     std::vector<glm::vec3> vertexNormals;
-    std::vector<uint32_t> indexOffsets;
-    std::vector<uint32_t> vertexOffsets;
+    std::vector<MeshDrawGroup> drawGroups;
+    uint32_t firstUint32Object{0}; // Cull objects before it use 16-bit indices, the rest 32-bit indices
     std::vector<DirectX::XMMATRIX>* transformMatrices;
+    std::vector<ObjectCullData> objectCullData;
+    std::vector<MotionState> motionStates;
 
     // shaders
-    std::vector<char> vertShaderCode;
-    std::vector<char> fragShaderCode;
+    std::vector<char> cullShaderCode;
+    std::vector<char> integrateShaderCode;
     void loadShaders();
+    std::vector<char> readShaderFile(const std::string &fileName);
     VkShaderModule createShaderModule(const std::vector<char> &code);
     
+    void createCommandPools();
     void destroyCommandPools();
+    void resetFrameCommandPools();
 
     void createVertexBindingDescriptors();
-    void createGraphicsPipeline();
+    void createPipelineManager();
+    GraphicsPipelineKey getGraphicsPipelineKey();
+    void selectGraphicsPipeline();
+    void createCullPipeline();
+    void createIntegratePipeline();
+    void logPipelineCreation(const char *name, float seconds);
 
-    void createGraphicsCommandBuffers();
-    void createTransferCommandBuffers();
-    void createPresentCommandBuffers();
     void recordGraphicsCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaryContents);
+    void endRendering(VkCommandBuffer commandBuffer);
+    void recordPresentBarrier(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordDrawState(VkCommandBuffer commandBuffer);
+    void recordDrawGroups(VkCommandBuffer commandBuffer, size_t firstGroup, size_t groupCount);
+    uint32_t recordSecondaryCommandBuffers(uint32_t imageIndex);
+    void recordCullPass(VkCommandBuffer commandBuffer);
+    void getFrustumPlanes(glm::vec4 planes[6]);
+    void integrateTransforms();
     void recordPresentCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void acquireNextImage();
     void drawFrame();
     
+    void createSwapchain();
     void handleSurfaceResize();
+    void createRenderTargets();
+    void destroyRenderTargets();
 
-    void freeCommandBuffers();
-    
     void createSyncObjects();
     void destroySyncObjects();
+    void createSwapchainSemaphores();
+    void destroySwapchainSemaphores();
+
+    void createFrameResources();
+    void destroyFrameResources();
 
     void createVertexBuffer();
-    void createIndexBuffer();
+    void createIndexBuffers();
+    void createIndexBuffer(IndexType indexType, const void *data, VkDeviceSize bufferSize);
+    static VkIndexType toVkIndexType(IndexType indexType);
     void createVertexNormalsBuffer();
     void createTransformMatricesBuffer();
+    VkDeviceSize writeTransformMatrices(uint32_t currentImage, const std::vector<DirtyRange> &ranges);
+    VkDeviceSize stageTransformMatrices(uint32_t currentImage, const std::vector<DirtyRange> &ranges);
+    void reportTransformUpload(float seconds);
+    void createCullBuffers();
+    void createIndirectDrawBuffers();
+    void createMotionStateBuffer();
 
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    void createUploadRing();
+    void uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size);
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
-                      VkDeviceMemory &bufferMemory);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, bool withSemaphores);
+                      VmaAllocation &bufferAllocation, bool sharedWithTransferQueue = false,
+                      VmaAllocationCreateFlags allocationFlags = 0, bool sharedWithComputeQueue = false);
+    uint64_t copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    uint64_t copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy2> &regions,
+                        std::optional<GpuScope> profilerScope = std::nullopt);
     void createDescriptorSetLayouts();
-    void createUniformBuffers();
     void createDescriptorPool();
     void createDescriptorSets();
 };